@@ -0,0 +1,144 @@
+#include <opsy.hpp>
+#include <Semihosting.hpp>
+
+#include <atomic>
+
+using namespace opsy;
+using namespace opsy::benchmark;
+using namespace std::chrono_literals;
+
+static_assert(kEdfScheduling, "build with -DOPSY_EDF_SCHEDULING=true");
+
+namespace
+{
+
+constexpr std::size_t kWorkers = 3;
+constexpr duration kPeriods[kWorkers] = { 5ms, 7ms, 11ms }; // not harmonic, fixed priorities cannot use the whole processor
+constexpr auto kPhase = 770ms; // two hyperperiods
+constexpr auto kCalibration = 100ms;
+constexpr uint32_t kChunkLoops = 1000;
+constexpr uint32_t kUtilizations[] = { 70, 80, 90, 95 }; // in percent, shared evenly between the workers
+
+constexpr auto kEdfPriority = static_cast<Priority>(0x20);
+constexpr Priority kRatePriorities[kWorkers] = { static_cast<Priority>(0x20), static_cast<Priority>(0x21), static_cast<Priority>(0x22) }; // rate monotonic, the shortest period first
+
+struct Phase
+{
+	const char* name;
+	uint32_t utilization;
+	uint32_t jobs;
+	uint32_t misses;
+};
+
+Task<256> s_workers[kWorkers];
+Task<1024> s_control;
+
+uint32_t s_loopsPerMs = 0;
+volatile uint32_t s_jobs = 0;
+volatile uint32_t s_misses = 0;
+
+void work(uint32_t loops)
+{
+	for (auto i = 0u; i < loops; ++i)
+		CortexM::nop();
+}
+
+/**
+ * @brief Measures how many loops of @c work last a millisecond, with no other task running
+ */
+void calibrate()
+{
+	sleep_for(0ms); // start on a tick
+	const auto start = Scheduler::now();
+	uint32_t loops = 0;
+	while (Scheduler::now() < start + kCalibration)
+	{
+		work(kChunkLoops);
+		loops += kChunkLoops;
+		std::atomic_signal_fence(std::memory_order_seq_cst); // the ticks are updated by the Systick, read them again
+	}
+	s_loopsPerMs = loops / static_cast<uint32_t>(kCalibration.count());
+}
+
+/**
+ * @brief Runs the task set for @c kPhase and counts the jobs that end after their deadline (the end of their period)
+ * @param name The name of the phase
+ * @param utilization The processor utilization of the task set, in percent
+ * @param edf @c true to give the workers the same @c Priority and their period as relative deadline, @c false for rate monotonic priorities
+ */
+Phase run(const char* name, uint32_t utilization, bool edf)
+{
+	s_jobs = 0;
+	s_misses = 0;
+
+	const auto start = Scheduler::now() + 10ms;
+	for (auto i = 0u; i < kWorkers; ++i)
+	{
+		auto& worker = s_workers[i];
+		worker.priority(edf ? kEdfPriority : kRatePriorities[i]);
+		worker.relativeDeadline(edf ? kPeriods[i] : duration(0));
+		const auto loops = static_cast<uint32_t>(static_cast<uint64_t>(s_loopsPerMs) * kPeriods[i].count() * utilization / (100 * kWorkers));
+		worker.start([start, i, loops]()
+			{
+				auto release = start;
+				while (true)
+				{
+					sleep_until(release); // returns right away when the previous job ended late
+					work(loops);
+					s_jobs = s_jobs + 1;
+					if (Scheduler::now() > release + kPeriods[i])
+						s_misses = s_misses + 1;
+					release += kPeriods[i];
+				}
+			}, "worker");
+	}
+
+	sleep_until(start + kPhase);
+
+	for (auto& worker : s_workers)
+		worker.stop();
+
+	return Phase { name, utilization, s_jobs, s_misses };
+}
+
+void report(const Phase* phases, std::size_t count)
+{
+	print("{\n\t\"machine\": \"mps2-an386\",\n\t\"core_clock\": %lu,\n\t\"loops_per_ms\": %lu,\n\t\"phases\": [\n",
+			static_cast<unsigned long>(getCoreClock()), static_cast<unsigned long>(s_loopsPerMs));
+
+	for (auto i = 0u; i < count; ++i)
+	{
+		const auto& phase = phases[i];
+		print("\t\t{ \"name\": \"%s\", \"utilization\": %lu, \"jobs\": %lu, \"misses\": %lu }%s\n", phase.name,
+				static_cast<unsigned long>(phase.utilization), static_cast<unsigned long>(phase.jobs), static_cast<unsigned long>(phase.misses),
+				i + 1 < count ? "," : "");
+	}
+
+	print("\t]\n}\n");
+}
+
+}
+
+int main()
+{
+	s_control.priority(Priority::Highest);
+	s_control.start([]()
+		{
+			constexpr std::size_t kPhases = 2 * sizeof(kUtilizations) / sizeof(kUtilizations[0]);
+			Phase phases[kPhases];
+			std::size_t count = 0;
+
+			calibrate();
+			for (const auto utilization : kUtilizations)
+			{
+				phases[count++] = run("fixed_priority", utilization, false);
+				phases[count++] = run("edf", utilization, true);
+			}
+
+			report(phases, count);
+			Semihosting::exit();
+		}, "control");
+
+	Scheduler::start();
+	return -1;
+}
@@ -0,0 +1,293 @@
+#include <opsy.hpp>
+#include <Semihosting.hpp>
+
+#include <mutex>
+
+using namespace opsy;
+using namespace opsy::benchmark;
+using namespace std::chrono_literals;
+
+#ifndef OPSY_BENCH_ICOUNT_SHIFT
+#define OPSY_BENCH_ICOUNT_SHIFT 0 // must match the -icount shift given to QEMU, each instruction then lasts 2^shift ns of virtual time
+#endif
+
+namespace
+{
+
+constexpr uint32_t kIterations = 1000;
+constexpr uint32_t kSleepIterations = 100; // each one lasts at least up to the next tick
+constexpr uint32_t kHoldLoops = 100; // work done while holding a mutex, in wake latency measurements
+constexpr std::size_t kMaxResults = 24;
+
+constexpr auto kBenchPriority = static_cast<Priority>(0x10);
+constexpr auto kAbovePriority = static_cast<Priority>(0x08);
+constexpr auto kBelowPriority = static_cast<Priority>(0x18);
+constexpr auto kCeilingPriority = static_cast<Priority>(0x0C); // above the benchmark, below the waiter
+
+constexpr uint32_t kSoftwareIrq = 31; // not connected to any peripheral on the mps2-an386
+constexpr auto kInterruptPriority = Semaphore::kPriority; // the most important level allowed to use OpSy
+
+struct Result
+{
+	const char* name;
+	uint32_t iterations;
+	uint32_t cycles; // for all the iterations, loop overhead removed
+};
+
+Result s_results[kMaxResults];
+std::size_t s_resultCount = 0;
+bool s_dwt = false;
+uint32_t s_loopCycles = 0; // cost of an empty iteration, times kIterations
+uint32_t s_timestampCycles = 0; // cost of reading a timestamp
+
+Task<1024> s_bench;
+Task<256> s_waiter;
+Task<256> s_partner;
+ConditionVariable s_wake;
+volatile uint32_t s_wokenAt = 0;
+volatile bool s_switching = false;
+
+Mutex s_taskMutex;
+Mutex s_basepriMutex(IsrPriority::FromPreemptSub<kPreemptionBits>(kOpsyPreemption + 1, 0));
+Mutex s_primaskMutex(IsrPriority(0));
+CeilingMutex s_ceilingMutex(kCeilingPriority);
+InheritanceMutex s_inheritanceMutex;
+
+/**
+ * @brief The counting semaphore built from a @c ConditionVariable and a @c Mutex, the usual pattern without @c Semaphore
+ */
+class CvSemaphore
+{
+public:
+
+	void acquire()
+	{
+		std::unique_lock<Mutex> lock(m_mutex);
+		while (m_count == 0)
+			m_available.wait(m_mutex);
+		--m_count;
+	}
+
+	void release()
+	{
+		std::lock_guard<Mutex> lock(m_mutex);
+		++m_count;
+		m_available.notify_one();
+	}
+
+private:
+
+	Mutex m_mutex { kInterruptPriority };
+	ConditionVariable m_available { kInterruptPriority };
+	uint32_t m_count = 0;
+};
+
+Task<256> s_semaphoreWaiter;
+Task<256> s_cvSemaphoreWaiter;
+Task<256> s_notifyWaiter;
+Task<256> s_isrWakeWaiter;
+Semaphore s_semaphore;
+CvSemaphore s_cvSemaphore;
+ConditionVariable s_isrWake(kInterruptPriority);
+
+/**
+ * @brief Gets a core cycle timestamp, modulo 2^32
+ * @remark Uses the DWT cycle counter when it runs, otherwise the scheduler ticks and the Systick counter (QEMU does not implement the DWT)
+ */
+uint32_t timestamp()
+{
+	if (s_dwt)
+		return CortexM::cycleCount();
+
+	const uint32_t tickCycles = static_cast<uint32_t>(static_cast<uint64_t>(getCoreClock()) * duration::period::num / duration::period::den);
+
+	while (true)
+	{
+		const auto ticks = Scheduler::now().time_since_epoch().count();
+		const auto count = CortexM::systickCount();
+		if (Scheduler::now().time_since_epoch().count() == ticks) // no tick in between, the counter value belongs to this tick
+			return static_cast<uint32_t>(ticks) * tickCycles + count;
+	}
+}
+
+template<typename Operation>
+uint32_t measure(uint32_t iterations, Operation&& operation)
+{
+	const auto start = timestamp();
+	for (auto i = 0u; i < iterations; ++i)
+		operation();
+	return timestamp() - start;
+}
+
+void record(const char* name, uint32_t iterations, uint32_t cycles)
+{
+	assert(s_resultCount < kMaxResults);
+	const auto overhead = static_cast<uint32_t>(static_cast<uint64_t>(s_loopCycles) * iterations / kIterations);
+	s_results[s_resultCount++] = Result { name, iterations, cycles > overhead ? cycles - overhead : 0 };
+}
+
+template<typename Operation>
+void run(const char* name, uint32_t iterations, Operation&& operation)
+{
+	record(name, iterations, measure(iterations, operation));
+}
+
+void calibrate()
+{
+	const auto before = CortexM::cycleCount();
+	for (auto i = 0; i < 16; ++i)
+		CortexM::nop();
+	s_dwt = CortexM::cycleCount() != before;
+
+	s_loopCycles = measure(kIterations, []() { asm volatile(""); });
+	s_timestampCycles = measure(kIterations, []() { timestamp(); }) / kIterations;
+}
+
+void notifyToWake()
+{
+	s_waiter.priority(kAbovePriority);
+	s_waiter.start([]()
+		{
+			while (true)
+			{
+				s_wake.wait();
+				s_wokenAt = timestamp();
+			}
+		}, "waiter"); // it preempts the benchmark and waits
+
+	uint32_t cycles = 0;
+	for (auto i = 0u; i < kIterations; ++i)
+	{
+		const auto start = timestamp();
+		s_wake.notify_one(); // the waiter preempts, takes its timestamp and waits again
+		cycles += s_wokenAt - start - s_timestampCycles;
+	}
+	s_results[s_resultCount++] = Result { "notify_one_to_wake", kIterations, cycles }; // not a loop, no overhead to remove
+}
+
+template<typename Lockable>
+void wakeInMutex(const char* name, Lockable& mutex)
+{
+	uint32_t cycles = 0;
+	for (auto i = 0u; i < kIterations; ++i)
+	{
+		mutex.lock();
+		const auto start = timestamp();
+		s_wake.notify_one(); // the waiter runs now if the mutex lets it, or when it is released
+		for (auto j = 0u; j < kHoldLoops; ++j)
+			CortexM::nop();
+		mutex.unlock();
+		cycles += s_wokenAt - start - s_timestampCycles;
+	}
+	s_results[s_resultCount++] = Result { name, kIterations, cycles }; // not a loop, no overhead to remove
+}
+
+void causeInterrupt()
+{
+	CortexM::setPending(kSoftwareIrq);
+	CortexM::dataBarrier(); // the interrupt is taken before going on
+	CortexM::instructionBarrier();
+}
+
+template<typename Wait>
+void isrToTask(const char* name, Task<256>& waiter, CortexM::IsrHandler handler, Wait wait)
+{
+	CortexM::setIsrHandler(kSoftwareIrq, handler);
+	waiter.priority(kAbovePriority);
+	waiter.start([wait]()
+		{
+			while (true)
+			{
+				wait();
+				s_wokenAt = timestamp();
+			}
+		}, name); // it preempts the benchmark and waits
+
+	uint32_t cycles = 0;
+	for (auto i = 0u; i < kIterations; ++i)
+	{
+		const auto start = timestamp();
+		causeInterrupt(); // the handler gives, the waiter preempts when it returns, takes its timestamp and waits again
+		cycles += s_wokenAt - start - s_timestampCycles;
+	}
+	s_results[s_resultCount++] = Result { name, kIterations, cycles }; // not a loop, no overhead to remove
+}
+
+void switchRoundTrip()
+{
+	s_switching = true;
+	s_partner.priority(kBelowPriority);
+	s_partner.start([]()
+		{
+			while (s_switching)
+				s_partner.priority(kBelowPriority); // switches back to the benchmark
+			s_wake.wait(); // done, never runs again
+		}, "partner");
+
+	run("switch_round_trip", kIterations, []() { s_partner.priority(kAbovePriority); }); // switches to the partner
+	s_switching = false;
+	s_partner.priority(kAbovePriority); // let it finish
+}
+
+void report()
+{
+	print("{\n\t\"machine\": \"mps2-an386\",\n\t\"core_clock\": %lu,\n\t\"clock\": \"%s\",\n\t\"icount_shift\": %d,\n\t\"results\": [\n",
+			static_cast<unsigned long>(getCoreClock()), s_dwt ? "dwt" : "systick", OPSY_BENCH_ICOUNT_SHIFT);
+
+	for (auto i = 0u; i < s_resultCount; ++i)
+	{
+		const auto& result = s_results[i];
+		const auto cycles = static_cast<uint64_t>(result.cycles) * 10 / result.iterations; // one decimal, newlib nano has no floating point printf
+		print("\t\t{ \"name\": \"%s\", \"iterations\": %lu, \"cycles\": %lu.%lu, ", result.name, static_cast<unsigned long>(result.iterations),
+				static_cast<unsigned long>(cycles / 10), static_cast<unsigned long>(cycles % 10));
+
+		if (s_dwt) // running on a real core, instructions are not known
+			print("\"instructions\": null }%s\n", i + 1 < s_resultCount ? "," : "");
+		else // under -icount, the virtual clock (hence the Systick) advances 2^shift ns per instruction
+		{
+			const auto instructions = static_cast<uint64_t>(result.cycles) * 10 * 1000000000u / getCoreClock() / (1u << OPSY_BENCH_ICOUNT_SHIFT) / result.iterations;
+			print("\"instructions\": %lu.%lu }%s\n", static_cast<unsigned long>(instructions / 10), static_cast<unsigned long>(instructions % 10),
+					i + 1 < s_resultCount ? "," : "");
+		}
+	}
+
+	print("\t]\n}\n");
+}
+
+}
+
+int main()
+{
+	CortexM::setPriority(kSoftwareIrq, kInterruptPriority);
+	CortexM::enableInterrupt(kSoftwareIrq);
+
+	s_bench.priority(kBenchPriority);
+	s_bench.start([]()
+		{
+			calibrate();
+
+			run("critical_section", kIterations, []() { auto section = Scheduler::criticalSection(); });
+			run("mutex_task", kIterations, []() { s_taskMutex.lock(); s_taskMutex.unlock(); });
+			run("mutex_basepri", kIterations, []() { s_basepriMutex.lock(); s_basepriMutex.unlock(); });
+			run("mutex_primask", kIterations, []() { s_primaskMutex.lock(); s_primaskMutex.unlock(); });
+			run("mutex_ceiling", kIterations, []() { s_ceilingMutex.lock(); s_ceilingMutex.unlock(); });
+			run("mutex_inheritance", kIterations, []() { s_inheritanceMutex.lock(); s_inheritanceMutex.unlock(); });
+			run("sleep_for_0", kSleepIterations, []() { sleep_for(0ms); });
+			run("semaphore_give_take", kIterations, []() { s_semaphore.release(); s_semaphore.acquire(); });
+			run("cv_semaphore_give_take", kIterations, []() { s_cvSemaphore.release(); s_cvSemaphore.acquire(); });
+			notifyToWake();
+			wakeInMutex("wake_in_mutex_task", s_taskMutex);
+			wakeInMutex("wake_in_mutex_ceiling", s_ceilingMutex);
+			isrToTask("isr_notify_one_to_wake", s_isrWakeWaiter, []() { s_isrWake.notify_one(); }, []() { s_isrWake.wait(); });
+			isrToTask("isr_notify_to_wake", s_notifyWaiter, []() { s_notifyWaiter.notify(NotifyAction::Increment); }, []() { Scheduler::waitNotification(); });
+			isrToTask("isr_semaphore_to_wake", s_semaphoreWaiter, []() { s_semaphore.release(); }, []() { s_semaphore.acquire(); });
+			isrToTask("isr_cv_semaphore_to_wake", s_cvSemaphoreWaiter, []() { s_cvSemaphore.release(); }, []() { s_cvSemaphore.acquire(); });
+			switchRoundTrip();
+
+			report();
+			Semihosting::exit();
+		}, "bench");
+
+	Scheduler::start();
+	return -1;
+}
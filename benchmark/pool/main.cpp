@@ -0,0 +1,181 @@
+#include <opsy.hpp>
+#include <Semihosting.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+
+using namespace opsy;
+using namespace opsy::benchmark;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+constexpr uint32_t kIterations = 1024; // allocate and free pairs of each phase
+constexpr std::size_t kBlocks = 16;
+constexpr std::size_t kBlockSize = 128; // as Thread-Metric
+constexpr std::size_t kHoles = 64; // small blocks left free in the heap of the fragmented phase
+constexpr std::size_t kHoleSize = 24;
+
+using Block = std::array<uint8_t, kBlockSize>;
+
+struct Phase
+{
+	const char* name;
+	uint32_t pairs;
+	uint32_t cycles; // for all the pairs
+	uint32_t worst; // of a single allocation
+	bool valid;
+};
+
+Task<1024> s_bench;
+MemoryPool<Block, kBlocks> s_pool;
+uint32_t s_timestampCycles = 0;
+void* s_kept[kHoles]; // the small blocks around the holes, never freed
+
+/**
+ * @brief Gets a core cycle timestamp, modulo 2^32, from the scheduler ticks and the Systick counter (QEMU does not implement the DWT)
+ */
+uint32_t timestamp()
+{
+	const uint32_t tickCycles = static_cast<uint32_t>(static_cast<uint64_t>(getCoreClock()) * duration::period::num / duration::period::den);
+
+	while (true)
+	{
+		const auto ticks = Scheduler::now().time_since_epoch().count();
+		const auto count = CortexM::systickCount();
+		if (Scheduler::now().time_since_epoch().count() == ticks) // no tick in between, the counter value belongs to this tick
+			return static_cast<uint32_t>(ticks) * tickCycles + count;
+	}
+}
+
+/**
+ * @brief Gets the cycles elapsed since @p start, the cost of reading the timestamp removed
+ */
+uint32_t elapsed(uint32_t start)
+{
+	const auto cycles = timestamp() - start;
+	return cycles > s_timestampCycles ? cycles - s_timestampCycles : 0;
+}
+
+void* poolAllocate()
+{
+	return s_pool.try_allocate();
+}
+
+void poolFree(void* block)
+{
+	s_pool.deallocate(static_cast<Block*>(block));
+}
+
+void* heapAllocate()
+{
+	return std::malloc(kBlockSize);
+}
+
+void heapFree(void* block)
+{
+	std::free(block);
+}
+
+/**
+ * @brief Allocates @p batch blocks then frees them, the even ones first, until @c kIterations pairs are done
+ * @remark Each allocation and each free is timed alone, each block is filled and checked before it is freed
+ */
+template<typename Allocate, typename Free>
+Phase run(const char* name, std::size_t batch, Allocate allocate, Free free)
+{
+	Phase phase { name, 0, 0, 0, true };
+	void* blocks[kBlocks];
+
+	while (phase.pairs < kIterations)
+	{
+		for (auto i = 0u; i < batch; ++i)
+		{
+			const auto start = timestamp();
+			blocks[i] = allocate();
+			const auto cycles = elapsed(start);
+			phase.cycles += cycles;
+			phase.worst = std::max(phase.worst, cycles);
+			if (blocks[i] == nullptr)
+				return Phase { name, 0, 0, 0, false };
+			std::fill_n(static_cast<uint8_t*>(blocks[i]), kBlockSize, static_cast<uint8_t>(i));
+		}
+
+		for (auto pass = 0u; pass < 2; ++pass) // the even ones, then the odd ones, so the free blocks are not in allocation order
+			for (auto i = pass; i < batch; i += 2)
+			{
+				const auto data = static_cast<const uint8_t*>(blocks[i]);
+				if (!std::all_of(data, data + kBlockSize, [i](uint8_t value) { return value == static_cast<uint8_t>(i); }))
+					phase.valid = false;
+
+				const auto start = timestamp();
+				free(blocks[i]);
+				phase.cycles += elapsed(start);
+			}
+
+		phase.pairs += batch;
+	}
+
+	return phase;
+}
+
+/**
+ * @brief Leaves @c kHoles small free blocks between small allocated ones in the heap, the next allocations have to skip them
+ */
+void fragmentHeap()
+{
+	void* holes[kHoles];
+
+	for (auto i = 0u; i < kHoles; ++i)
+	{
+		holes[i] = std::malloc(kHoleSize);
+		s_kept[i] = std::malloc(kHoleSize);
+	}
+	for (auto hole : holes)
+		std::free(hole);
+}
+
+void report(const Phase* phases, std::size_t count)
+{
+	print("{\n\t\"machine\": \"mps2-an386\",\n\t\"core_clock\": %lu,\n\t\"block_bytes\": %lu,\n\t\"blocks\": %lu,\n\t\"phases\": [\n",
+			static_cast<unsigned long>(getCoreClock()), static_cast<unsigned long>(kBlockSize), static_cast<unsigned long>(kBlocks));
+
+	for (auto i = 0u; i < count; ++i)
+	{
+		const auto& phase = phases[i];
+		print("\t\t{ \"name\": \"%s\", \"cycles_per_pair\": %lu, \"worst_allocate_cycles\": %lu, \"valid\": %s }%s\n", phase.name,
+				static_cast<unsigned long>(phase.pairs != 0 ? phase.cycles / phase.pairs : 0), static_cast<unsigned long>(phase.worst),
+				phase.valid ? "true" : "false", i + 1 < count ? "," : "");
+	}
+
+	print("\t]\n}\n");
+}
+
+}
+
+int main()
+{
+	s_bench.start([]()
+		{
+			const auto start = timestamp();
+			for (auto i = 0u; i < kIterations; ++i)
+				timestamp();
+			s_timestampCycles = (timestamp() - start) / kIterations;
+
+			Phase phases[5];
+			phases[0] = run("pool_single", 1, poolAllocate, poolFree);
+			phases[1] = run("pool_batch", kBlocks, poolAllocate, poolFree);
+			phases[2] = run("malloc_single", 1, heapAllocate, heapFree);
+			phases[3] = run("malloc_batch", kBlocks, heapAllocate, heapFree);
+			fragmentHeap();
+			phases[4] = run("malloc_fragmented", kBlocks, heapAllocate, heapFree);
+
+			report(phases, sizeof(phases) / sizeof(phases[0]));
+			Semihosting::exit();
+		}, "bench");
+
+	Scheduler::start();
+	return -1;
+}
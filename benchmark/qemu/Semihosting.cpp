@@ -0,0 +1,19 @@
+#include "Semihosting.hpp"
+
+#include <cstdarg>
+#include <cstdio>
+
+namespace opsy::benchmark
+{
+
+void print(const char* format, ...)
+{
+	char buffer[160];
+	va_list arguments;
+	va_start(arguments, format);
+	std::vsnprintf(buffer, sizeof(buffer), format, arguments);
+	va_end(arguments);
+	Semihosting::write(buffer);
+}
+
+}
@@ -0,0 +1,100 @@
+/**
+ ******************************************************************************
+ * @file    Semihosting.hpp
+ * @author  Thomas Legrand
+ * @version V0.1
+ * @date    16-October-2026
+ * @brief   Semihosting calls used by the QEMU benchmarks
+ *
+ * 			This file contains the few ARM semihosting calls the benchmarks need
+ * 			to report their results and exit QEMU, and the @c print function
+ * 			they format their reports with (Semihosting.cpp).
+ *
+ * 			Run QEMU with @c -semihosting-config @c enable=on,target=native so the
+ * 			calls are handled by the host.
+ *
+ ******************************************************************************
+ * @copyright Copyright 2019 Thomas Legrand under the MIT License
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************
+ * @see https://github.com/Otatiaro/OpSy
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace opsy::benchmark
+{
+
+/**
+ * @brief Minimal ARM semihosting interface, used to print results and exit the simulation
+ */
+class Semihosting
+{
+public:
+
+	/**
+	 * @brief Writes a null terminated string to the host console
+	 * @param text The string to write
+	 */
+	static void write(const char* text)
+	{
+		call(SysWrite0, text);
+	}
+
+	/**
+	 * @brief Ends the simulation
+	 * @param success @c true to exit QEMU with status 0, @c false to exit with status 1
+	 */
+	[[noreturn]] static void exit(bool success = true)
+	{
+		call(SysExit, reinterpret_cast<const void*>(success ? AdpStoppedApplicationExit : AdpStoppedRunTimeErrorUnknown));
+		while (true)
+			;
+	}
+
+private:
+
+	static constexpr uintptr_t SysWrite0 = 0x04;
+	static constexpr uintptr_t SysExit = 0x18;
+	static constexpr uintptr_t AdpStoppedApplicationExit = 0x20026;
+	static constexpr uintptr_t AdpStoppedRunTimeErrorUnknown = 0x20023;
+
+	static uintptr_t call(uintptr_t operation, const void* argument)
+	{
+		register uintptr_t r0 asm("r0") = operation;
+		register const void* r1 asm("r1") = argument;
+		asm volatile("bkpt 0xAB" : "+r"(r0) : "r"(r1) : "memory");
+		return r0;
+	}
+};
+
+/**
+ * @brief Formats a string as @c printf does and writes it to the host console
+ * @param format The @c printf format, the result is cut at 160 characters
+ */
+void print(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+}
@@ -0,0 +1,77 @@
+#include <CortexM.hpp>
+#include "Semihosting.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+extern "C"
+{
+
+uint32_t SystemCoreClock = 25000000; // the mps2-an386 Cortex-M4 and its Systick are clocked at 25MHz
+
+extern uint32_t _estack;
+extern uint32_t _sidata;
+extern uint32_t _sdata;
+extern uint32_t _edata;
+extern uint32_t _sbss;
+extern uint32_t _ebss;
+
+void __libc_init_array();
+int main();
+
+void Reset_Handler();
+void SVC_Handler();
+void PendSV_Handler();
+void SysTick_Handler();
+
+void Default_Handler()
+{
+	opsy::benchmark::Semihosting::write("unexpected exception\n");
+	opsy::benchmark::Semihosting::exit(false);
+}
+
+void NMI_Handler() __attribute__((weak, alias("Default_Handler")));
+void HardFault_Handler() __attribute__((weak, alias("Default_Handler")));
+void MemManage_Handler() __attribute__((weak, alias("Default_Handler")));
+void BusFault_Handler() __attribute__((weak, alias("Default_Handler")));
+void UsageFault_Handler() __attribute__((weak, alias("Default_Handler")));
+void DebugMon_Handler() __attribute__((weak, alias("Default_Handler")));
+
+constexpr std::size_t kIrqCount = 64; // the mps2-an386 NVIC implements 64 external interrupts
+
+__attribute__((section(".isr_vector"), used)) opsy::CortexM::IsrHandler g_vector[opsy::CortexM::kSystemIrqs + kIrqCount] = // not const, so CortexM::setIsrHandler can update it in place
+{
+	reinterpret_cast<opsy::CortexM::IsrHandler>(&_estack),
+	Reset_Handler,
+	NMI_Handler,
+	HardFault_Handler,
+	MemManage_Handler,
+	BusFault_Handler,
+	UsageFault_Handler,
+	nullptr,
+	nullptr,
+	nullptr,
+	nullptr,
+	SVC_Handler,
+	DebugMon_Handler,
+	nullptr,
+	PendSV_Handler,
+	SysTick_Handler,
+};
+
+void Reset_Handler()
+{
+	opsy::CortexM::enableFpu(); // the benchmarks are built for the hardware floating point ABI
+	opsy::CortexM::enableCycleCount();
+
+	std::memcpy(&_sdata, &_sidata, static_cast<std::size_t>(&_edata - &_sdata) * sizeof(uint32_t));
+	std::memset(&_sbss, 0, static_cast<std::size_t>(&_ebss - &_sbss) * sizeof(uint32_t));
+
+	for (auto i = 0u; i < kIrqCount; ++i) // peripheral interrupts are set by the benchmark that uses them
+		g_vector[opsy::CortexM::kSystemIrqs + i] = Default_Handler;
+
+	__libc_init_array();
+	opsy::benchmark::Semihosting::exit(main() == 0); // main only returns if the scheduler failed to start
+}
+
+}
@@ -0,0 +1,171 @@
+#include <opsy.hpp>
+#include <Semihosting.hpp>
+
+#include <array>
+
+using namespace opsy;
+using namespace opsy::benchmark;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+constexpr uint32_t kMessages = 10000; // sent in each phase
+constexpr std::size_t kCapacity = 8;
+constexpr std::size_t kTasks = 4; // senders of n_to_1, receivers of 1_to_n
+
+constexpr auto kHighPriority = static_cast<Priority>(0x08);
+constexpr auto kLowPriority = static_cast<Priority>(0x10);
+constexpr auto kControlPriority = static_cast<Priority>(0x18); // runs only when the phase is done
+
+using Message = std::array<uint32_t, 4>; // 16 bytes, as Thread-Metric
+using Queue = MessageQueue<Message, kCapacity>;
+
+struct Phase
+{
+	const char* name;
+	uint32_t cycles;
+	bool valid;
+};
+
+Task<512> s_senders[kTasks];
+Task<512> s_receivers[kTasks];
+Task<1024> s_control;
+
+Queue s_oneToOne;
+Queue s_nToOne;
+Queue s_oneToN;
+
+volatile uint32_t s_received = 0;
+volatile uint32_t s_sum = 0;
+volatile uint32_t s_doneAt = 0;
+volatile bool s_ordered = true;
+
+/**
+ * @brief Gets a core cycle timestamp, modulo 2^32, from the scheduler ticks and the Systick counter (QEMU does not implement the DWT)
+ */
+uint32_t timestamp()
+{
+	const uint32_t tickCycles = static_cast<uint32_t>(static_cast<uint64_t>(getCoreClock()) * duration::period::num / duration::period::den);
+
+	while (true)
+	{
+		const auto ticks = Scheduler::now().time_since_epoch().count();
+		const auto count = CortexM::systickCount();
+		if (Scheduler::now().time_since_epoch().count() == ticks) // no tick in between, the counter value belongs to this tick
+			return static_cast<uint32_t>(ticks) * tickCycles + count;
+	}
+}
+
+/**
+ * @brief Sends @p count messages, numbered from @p first
+ */
+void send(Queue& queue, uint32_t first, uint32_t count)
+{
+	Message message { 0, 0x55667788, 0x99AABBCC, 0xDDEEFF00 };
+	for (auto i = 0u; i < count; ++i)
+	{
+		message[0] = first + i;
+		queue.send(message);
+	}
+}
+
+/**
+ * @brief Receives messages forever, the last one timestamps the end of the phase
+ * @param ordered @c true if there is a single sender and a single receiver, the messages must then come in order
+ */
+void receive(Queue& queue, bool ordered)
+{
+	Message message;
+	while (true)
+	{
+		queue.receive(message);
+		if (ordered && message[0] != s_received)
+			s_ordered = false;
+		s_sum = s_sum + message[0];
+		s_received = s_received + 1; // receivers share a priority, without time slicing they do not preempt each other
+		if (s_received == kMessages)
+			s_doneAt = timestamp();
+	}
+}
+
+/**
+ * @brief Sends @c kMessages through @p queue from @p senders to @p receivers tasks
+ * @remark The control task is the least important, it only runs again once all the messages are received and every task waits
+ */
+Phase run(const char* name, Queue& queue, std::size_t senders, Priority senderPriority, std::size_t receivers, Priority receiverPriority)
+{
+	static Queue* s_queue;
+	static std::size_t s_senderCount;
+	static bool s_single;
+
+	s_queue = &queue;
+	s_senderCount = senders;
+	s_single = senders == 1 && receivers == 1;
+	s_received = 0;
+	s_sum = 0;
+	s_ordered = true;
+
+	for (auto i = 0u; i < receivers; ++i)
+	{
+		s_receivers[i].priority(receiverPriority);
+		s_receivers[i].start([]() { receive(*s_queue, s_single); }, "receiver"); // it waits for the first message
+	}
+
+	const auto start = timestamp();
+	for (auto i = 0u; i < senders; ++i)
+	{
+		s_senders[i].priority(senderPriority);
+		s_senders[i].start([i]() { send(*s_queue, i * (kMessages / s_senderCount), kMessages / s_senderCount); }, "sender");
+	}
+
+	while (s_received < kMessages)
+		Scheduler::yield();
+	const auto cycles = s_doneAt - start;
+
+	for (auto i = 0u; i < receivers; ++i)
+		s_receivers[i].stop();
+
+	const uint32_t expectedSum = kMessages * (kMessages - 1) / 2;
+	return Phase { name, cycles, s_sum == expectedSum && s_ordered && queue.size() == 0 };
+}
+
+void report(const Phase* phases, std::size_t count)
+{
+	print("{\n\t\"machine\": \"mps2-an386\",\n\t\"core_clock\": %lu,\n\t\"messages\": %lu,\n\t\"message_bytes\": %lu,\n\t\"capacity\": %lu,\n\t\"phases\": [\n",
+			static_cast<unsigned long>(getCoreClock()), static_cast<unsigned long>(kMessages), static_cast<unsigned long>(sizeof(Message)),
+			static_cast<unsigned long>(kCapacity));
+
+	for (auto i = 0u; i < count; ++i)
+	{
+		const auto& phase = phases[i];
+		const auto rate = static_cast<uint64_t>(kMessages) * getCoreClock() / phase.cycles;
+		print("\t\t{ \"name\": \"%s\", \"cycles_per_message\": %lu, \"messages_per_s\": %lu, \"valid\": %s }%s\n", phase.name,
+				static_cast<unsigned long>(phase.cycles / kMessages), static_cast<unsigned long>(rate), phase.valid ? "true" : "false",
+				i + 1 < count ? "," : "");
+	}
+
+	print("\t]\n}\n");
+}
+
+}
+
+int main()
+{
+	s_control.priority(kControlPriority);
+	s_control.start([]()
+		{
+			Phase phases[] =
+			{
+				run("1_to_1", s_oneToOne, 1, kLowPriority, 1, kHighPriority),
+				run("n_to_1", s_nToOne, kTasks, kHighPriority, 1, kLowPriority),
+				run("1_to_n", s_oneToN, 1, kHighPriority, kTasks, kLowPriority),
+			};
+
+			report(phases, sizeof(phases) / sizeof(phases[0]));
+			Semihosting::exit();
+		}, "control");
+
+	Scheduler::start();
+	return -1;
+}
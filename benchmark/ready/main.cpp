@@ -0,0 +1,117 @@
+#include <opsy.hpp>
+#include <Semihosting.hpp>
+
+using namespace opsy;
+using namespace opsy::benchmark;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+constexpr uint32_t kIterations = 1000; // switch round trips of each phase
+constexpr std::size_t kReadyCounts[] = { 2, 10, 50, 100, 200 }; // ready tasks of each phase, the benchmark and its partner included
+constexpr std::size_t kPhases = sizeof(kReadyCounts) / sizeof(kReadyCounts[0]);
+constexpr std::size_t kFillers = kReadyCounts[kPhases - 1] - 2;
+constexpr std::size_t kFillerLevels = 16; // fillers are spread over that many priority levels
+
+constexpr auto kBenchPriority = static_cast<Priority>(0x10);
+constexpr auto kAbovePriority = static_cast<Priority>(0x08);
+constexpr auto kFillerPriority = static_cast<Priority>(0x20); // the most important filler level, below the benchmark
+constexpr auto kBelowPriority = static_cast<Priority>(0x40); // below every filler, the sorted list has to skip them all
+
+struct Phase
+{
+	std::size_t ready;
+	uint32_t cycles; // for all the round trips
+};
+
+Task<1024> s_bench;
+Task<256> s_partner;
+Task<128> s_fillers[kFillers]; // never run, they only stay in the ready queue
+std::size_t s_fillerCount = 0;
+ConditionVariable s_never;
+
+/**
+ * @brief Gets a core cycle timestamp, modulo 2^32, from the scheduler ticks and the Systick counter (QEMU does not implement the DWT)
+ */
+uint32_t timestamp()
+{
+	const uint32_t tickCycles = static_cast<uint32_t>(static_cast<uint64_t>(getCoreClock()) * duration::period::num / duration::period::den);
+
+	while (true)
+	{
+		const auto ticks = Scheduler::now().time_since_epoch().count();
+		const auto count = CortexM::systickCount();
+		if (Scheduler::now().time_since_epoch().count() == ticks) // no tick in between, the counter value belongs to this tick
+			return static_cast<uint32_t>(ticks) * tickCycles + count;
+	}
+}
+
+/**
+ * @brief Starts fillers until @p ready tasks are ready, they are less important than the benchmark so they never run
+ */
+void fill(std::size_t ready)
+{
+	for (; s_fillerCount + 2 < ready; ++s_fillerCount)
+	{
+		auto& filler = s_fillers[s_fillerCount];
+		filler.priority(static_cast<Priority>(static_cast<uint8_t>(kFillerPriority) + s_fillerCount % kFillerLevels));
+		filler.start([]() { s_never.wait(); }, "filler");
+	}
+}
+
+/**
+ * @brief Switches @c kIterations times to the partner and back
+ * @remark Switching to the partner moves it from the back of the ready queue to the front, switching back inserts it behind every filler
+ */
+Phase run(std::size_t ready)
+{
+	fill(ready);
+
+	const auto start = timestamp();
+	for (auto i = 0u; i < kIterations; ++i)
+		s_partner.priority(kAbovePriority); // switches to the partner
+	return Phase { ready, timestamp() - start };
+}
+
+void report(const Phase* phases, std::size_t count)
+{
+	print("{\n\t\"machine\": \"mps2-an386\",\n\t\"core_clock\": %lu,\n\t\"ready_queue\": \"%s\",\n\t\"phases\": [\n",
+			static_cast<unsigned long>(getCoreClock()), kBitmapReadyQueue ? "bitmap" : "list");
+
+	for (auto i = 0u; i < count; ++i)
+	{
+		const auto& phase = phases[i];
+		const auto cycles = static_cast<uint64_t>(phase.cycles) * 10 / (2 * kIterations); // one decimal, newlib nano has no floating point printf
+		print("\t\t{ \"ready_tasks\": %lu, \"cycles_per_switch\": %lu.%lu }%s\n", static_cast<unsigned long>(phase.ready),
+				static_cast<unsigned long>(cycles / 10), static_cast<unsigned long>(cycles % 10), i + 1 < count ? "," : "");
+	}
+
+	print("\t]\n}\n");
+}
+
+}
+
+int main()
+{
+	s_bench.priority(kBenchPriority);
+	s_bench.start([]()
+		{
+			s_partner.priority(kBelowPriority);
+			s_partner.start([]()
+				{
+					while (true)
+						s_partner.priority(kBelowPriority); // switches back to the benchmark
+				}, "partner");
+
+			Phase phases[kPhases];
+			for (auto i = 0u; i < kPhases; ++i)
+				phases[i] = run(kReadyCounts[i]);
+
+			report(phases, kPhases);
+			Semihosting::exit();
+		}, "bench");
+
+	Scheduler::start();
+	return -1;
+}
@@ -0,0 +1,236 @@
+#include <opsy.hpp>
+#include <Semihosting.hpp>
+
+#include <mutex>
+
+using namespace opsy;
+using namespace opsy::benchmark;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+constexpr uint32_t kBytes = 64 * 1024; // streamed in each phase
+constexpr uint32_t kBatch = 16; // bytes produced by each interrupt, as a UART or ADC FIFO would
+constexpr std::size_t kCapacity = 256;
+
+constexpr uint32_t kSoftwareIrq = 31; // not connected to any peripheral on the mps2-an386
+constexpr auto kInterruptPriority = SpscRing<uint8_t, kCapacity>::kPriority; // the most important level allowed to use OpSy
+
+constexpr auto kConsumerPriority = static_cast<Priority>(0x08);
+constexpr auto kControlPriority = static_cast<Priority>(0x10);
+
+struct Phase
+{
+	const char* name;
+	uint32_t cycles;
+	uint32_t wakes;
+	bool valid;
+};
+
+/**
+ * @brief A byte queue built from a @c ConditionVariable and a @c Mutex, each byte is pushed with the @c Mutex locked and notified
+ */
+class CvQueue
+{
+public:
+
+	bool push(uint8_t byte)
+	{
+		std::lock_guard<Mutex> lock(m_mutex);
+		if (m_size == kCapacity)
+			return false;
+		m_bytes[(m_first + m_size) % kCapacity] = byte;
+		++m_size;
+		m_available.notify_one();
+		return true;
+	}
+
+	/**
+	 * @brief Waits for bytes, then removes all of them
+	 * @param count Receives the number of bytes removed
+	 * @return The sum of the bytes removed
+	 */
+	uint32_t drain(uint32_t& count)
+	{
+		std::unique_lock<Mutex> lock(m_mutex);
+		while (m_size == 0)
+			m_available.wait(m_mutex);
+
+		uint32_t sum = 0;
+		count = m_size;
+		for (; m_size != 0; --m_size, m_first = (m_first + 1) % kCapacity)
+			sum += m_bytes[m_first];
+		return sum;
+	}
+
+private:
+
+	Mutex m_mutex { kInterruptPriority };
+	ConditionVariable m_available { kInterruptPriority };
+	uint8_t m_bytes[kCapacity] = { };
+	std::size_t m_first = 0;
+	std::size_t m_size = 0;
+};
+
+Task<512> s_consumer;
+Task<1024> s_control;
+
+CvQueue s_queue;
+SpscRing<uint8_t, kCapacity> s_pushRing;
+SpscRing<uint8_t, kCapacity> s_writeRing;
+
+volatile uint32_t s_produced = 0;
+volatile uint32_t s_consumed = 0;
+volatile uint32_t s_sum = 0;
+volatile uint32_t s_wakes = 0;
+uint32_t s_expectedSum = 0;
+
+/**
+ * @brief Gets a core cycle timestamp, modulo 2^32, from the scheduler ticks and the Systick counter (QEMU does not implement the DWT)
+ */
+uint32_t timestamp()
+{
+	const uint32_t tickCycles = static_cast<uint32_t>(static_cast<uint64_t>(getCoreClock()) * duration::period::num / duration::period::den);
+
+	while (true)
+	{
+		const auto ticks = Scheduler::now().time_since_epoch().count();
+		const auto count = CortexM::systickCount();
+		if (Scheduler::now().time_since_epoch().count() == ticks) // no tick in between, the counter value belongs to this tick
+			return static_cast<uint32_t>(ticks) * tickCycles + count;
+	}
+}
+
+uint8_t byteAt(uint32_t index)
+{
+	return static_cast<uint8_t>(index * 7 + (index >> 8));
+}
+
+void produceQueue()
+{
+	for (auto i = 0u; i < kBatch; ++i, s_produced = s_produced + 1)
+		s_queue.push(byteAt(s_produced)); // the consumer drains faster than the interrupts come, there is always room
+}
+
+void producePush()
+{
+	for (auto i = 0u; i < kBatch; ++i, s_produced = s_produced + 1)
+		s_pushRing.push(byteAt(s_produced));
+}
+
+void produceWrite()
+{
+	uint8_t batch[kBatch];
+	for (auto i = 0u; i < kBatch; ++i)
+		batch[i] = byteAt(s_produced + i);
+	s_writeRing.write(batch, kBatch); // published at once, the consumer is woken up once
+	s_produced = s_produced + kBatch;
+}
+
+template<typename Ring>
+void consumeRing(Ring& ring)
+{
+	while (true)
+	{
+		ring.wait();
+		s_wakes = s_wakes + 1;
+		uint32_t sum = 0;
+		uint32_t count = 0;
+		for (auto span = ring.readSpan(); span.size != 0; span = ring.readSpan()) // zero copy, read in place
+		{
+			for (auto i = 0u; i < span.size; ++i)
+				sum += span.data[i];
+			ring.consume(span.size);
+			count += span.size;
+		}
+		s_sum = s_sum + sum;
+		s_consumed = s_consumed + count;
+	}
+}
+
+/**
+ * @brief Streams @c kBytes from the software interrupt to the consumer
+ * @remark The control task triggers the interrupt in a loop, the consumer is more important so it runs as soon as the interrupt returns
+ */
+template<typename Consume>
+Phase run(const char* name, CortexM::IsrHandler producer, Consume consume)
+{
+	s_produced = 0;
+	s_consumed = 0;
+	s_sum = 0;
+	s_wakes = 0;
+
+	CortexM::setIsrHandler(kSoftwareIrq, producer);
+	s_consumer.priority(kConsumerPriority);
+	s_consumer.start(consume, name); // it preempts the control task and waits
+
+	const auto start = timestamp();
+	while (s_produced < kBytes)
+	{
+		CortexM::setPending(kSoftwareIrq);
+		CortexM::dataBarrier(); // the interrupt is taken before going on
+		CortexM::instructionBarrier();
+	}
+	while (s_consumed < kBytes) // it is more important, it is done already
+		Scheduler::yield();
+	const auto cycles = timestamp() - start;
+
+	s_consumer.stop();
+	return Phase { name, cycles, s_wakes, s_sum == s_expectedSum && s_consumed == kBytes };
+}
+
+void report(const Phase* phases, std::size_t count)
+{
+	print("{\n\t\"machine\": \"mps2-an386\",\n\t\"core_clock\": %lu,\n\t\"bytes\": %lu,\n\t\"batch\": %lu,\n\t\"phases\": [\n", static_cast<unsigned long>(getCoreClock()),
+			static_cast<unsigned long>(kBytes), static_cast<unsigned long>(kBatch));
+
+	for (auto i = 0u; i < count; ++i)
+	{
+		const auto& phase = phases[i];
+		const auto rate = static_cast<uint64_t>(kBytes) * getCoreClock() * 10 / phase.cycles / 1000000; // one decimal, newlib nano has no floating point printf
+		print("\t\t{ \"name\": \"%s\", \"cycles_per_byte\": %lu, \"mb_per_s\": %lu.%lu, \"wakes\": %lu, \"valid\": %s }%s\n", phase.name,
+				static_cast<unsigned long>(phase.cycles / kBytes), static_cast<unsigned long>(rate / 10), static_cast<unsigned long>(rate % 10),
+				static_cast<unsigned long>(phase.wakes), phase.valid ? "true" : "false", i + 1 < count ? "," : "");
+	}
+
+	print("\t]\n}\n");
+}
+
+}
+
+int main()
+{
+	for (auto i = 0u; i < kBytes; ++i)
+		s_expectedSum += byteAt(i);
+
+	CortexM::setPriority(kSoftwareIrq, kInterruptPriority);
+	CortexM::enableInterrupt(kSoftwareIrq);
+
+	s_control.priority(kControlPriority);
+	s_control.start([]()
+		{
+			Phase phases[] =
+			{
+				run("cv_queue", produceQueue, []()
+					{
+						while (true)
+						{
+							uint32_t count;
+							const auto sum = s_queue.drain(count);
+							s_wakes = s_wakes + 1;
+							s_sum = s_sum + sum;
+							s_consumed = s_consumed + count;
+						}
+					}),
+				run("ring_push", producePush, []() { consumeRing(s_pushRing); }),
+				run("ring_write", produceWrite, []() { consumeRing(s_writeRing); }),
+			};
+
+			report(phases, sizeof(phases) / sizeof(phases[0]));
+			Semihosting::exit();
+		}, "control");
+
+	Scheduler::start();
+	return -1;
+}
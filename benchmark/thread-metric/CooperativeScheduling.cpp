@@ -0,0 +1,35 @@
+#include "ThreadMetric.hpp"
+
+using namespace opsy;
+using namespace opsy::benchmark;
+
+namespace
+{
+
+constexpr std::size_t kTasks = 5;
+
+volatile uint32_t s_counters[kTasks];
+Task<256> s_tasks[kTasks];
+
+}
+
+/**
+ * Five tasks of the same priority increment their counter and yield to the next one
+ */
+int main()
+{
+	for (auto i = 0u; i < kTasks; ++i)
+	{
+		s_tasks[i].priority(Priority::Normal);
+		s_tasks[i].start([i]()
+			{
+				while (true)
+				{
+					s_counters[i] = s_counters[i] + 1;
+					Scheduler::yield();
+				}
+			});
+	}
+
+	run("Cooperative Scheduling", s_counters, kTasks, true);
+}
@@ -0,0 +1,50 @@
+#include "ThreadMetric.hpp"
+
+using namespace opsy;
+using namespace opsy::benchmark;
+
+namespace
+{
+
+volatile uint32_t s_counters[3]; // low priority task, interrupt, high priority task
+Task<256> s_low;
+Task<256> s_high;
+Semaphore s_resume(0, 1);
+
+void interruptHandler()
+{
+	s_counters[1] = s_counters[1] + 1;
+	s_resume.release(); // the high priority task preempts the low priority one when the interrupt returns
+}
+
+}
+
+/**
+ * A low priority task triggers an interrupt, which resumes a high priority task that counts and suspends itself
+ */
+int main()
+{
+	setInterruptHandler(interruptHandler);
+
+	s_high.priority(Priority::Highest);
+	s_high.start([]()
+		{
+			while (true)
+			{
+				s_resume.acquire();
+				s_counters[2] = s_counters[2] + 1;
+			}
+		});
+
+	s_low.priority(Priority::Normal);
+	s_low.start([]()
+		{
+			while (true)
+			{
+				causeInterrupt();
+				s_counters[0] = s_counters[0] + 1;
+			}
+		});
+
+	run("Interrupt Preemption Processing", s_counters, 3);
+}
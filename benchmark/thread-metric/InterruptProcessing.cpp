@@ -0,0 +1,39 @@
+#include "ThreadMetric.hpp"
+
+using namespace opsy;
+using namespace opsy::benchmark;
+
+namespace
+{
+
+volatile uint32_t s_counters[2]; // task, interrupt
+Task<256> s_task;
+Semaphore s_semaphore;
+
+void interruptHandler()
+{
+	s_counters[1] = s_counters[1] + 1;
+	s_semaphore.release();
+}
+
+}
+
+/**
+ * A task triggers an interrupt, which gives a semaphore that the task takes right after
+ */
+int main()
+{
+	setInterruptHandler(interruptHandler);
+
+	s_task.start([]()
+		{
+			while (true)
+			{
+				causeInterrupt();
+				s_semaphore.acquire();
+				s_counters[0] = s_counters[0] + 1;
+			}
+		});
+
+	run("Interrupt Processing", s_counters, 2);
+}
@@ -0,0 +1,34 @@
+#include "ThreadMetric.hpp"
+
+using namespace opsy;
+using namespace opsy::benchmark;
+
+namespace
+{
+
+using Block = std::array<uint8_t, 128>;
+
+volatile uint32_t s_counters[1];
+Task<256> s_task;
+MemoryPool<Block, 16> s_pool; // 2048 bytes
+
+}
+
+/**
+ * A task allocates a 128 bytes block and frees it
+ */
+int main()
+{
+	s_task.start([]()
+		{
+			while (true)
+			{
+				auto block = s_pool.try_allocate();
+				assert(block != nullptr);
+				s_pool.deallocate(block);
+				s_counters[0] = s_counters[0] + 1;
+			}
+		});
+
+	run("Memory Allocation", s_counters, 1);
+}
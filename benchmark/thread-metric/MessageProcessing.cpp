@@ -0,0 +1,38 @@
+#include "ThreadMetric.hpp"
+
+using namespace opsy;
+using namespace opsy::benchmark;
+
+namespace
+{
+
+using Message = std::array<uint32_t, 4>;
+
+volatile uint32_t s_counters[1];
+Task<256> s_task;
+MessageQueue<Message, 10> s_queue;
+
+}
+
+/**
+ * A task sends a 16 bytes message to a queue and receives it back
+ */
+int main()
+{
+	s_task.start([]()
+		{
+			Message sent { 0x11223344, 0x55667788, 0x99AABBCC, 0xDDEEFF00 };
+			Message received;
+
+			while (true)
+			{
+				s_queue.send(sent);
+				s_queue.receive(received);
+				assert(received == sent);
+				sent[3] = sent[3] + 1;
+				s_counters[0] = s_counters[0] + 1;
+			}
+		});
+
+	run("Message Processing", s_counters, 1);
+}
@@ -0,0 +1,44 @@
+#include "ThreadMetric.hpp"
+
+using namespace opsy;
+using namespace opsy::benchmark;
+
+namespace
+{
+
+constexpr std::size_t kTasks = 5;
+
+volatile uint32_t s_counters[kTasks];
+Task<256> s_tasks[kTasks];
+Semaphore s_resume[kTasks] = { Semaphore(0, 1), Semaphore(0, 1), Semaphore(0, 1), Semaphore(0, 1), Semaphore(0, 1) }; // suspends and resumes each task
+
+constexpr Priority priorityOf(std::size_t task)
+{
+	return static_cast<Priority>(static_cast<uint8_t>(Priority::Normal) - task); // the last task is the most important
+}
+
+}
+
+/**
+ * Five tasks of increasing priority, each one resumes the next one, which preempts it, counts and suspends itself
+ */
+int main()
+{
+	for (auto i = 0u; i < kTasks; ++i)
+	{
+		s_tasks[i].priority(priorityOf(i));
+		s_tasks[i].start([i]()
+			{
+				while (true)
+				{
+					if (i != 0) // the first task never suspends
+						s_resume[i].acquire();
+					if (i + 1 < kTasks)
+						s_resume[i + 1].release();
+					s_counters[i] = s_counters[i] + 1;
+				}
+			});
+	}
+
+	run("Preemptive Scheduling", s_counters, kTasks, true);
+}
@@ -0,0 +1,33 @@
+#include "ThreadMetric.hpp"
+
+using namespace opsy;
+using namespace opsy::benchmark;
+
+namespace
+{
+
+volatile uint32_t s_counters[1];
+Task<256> s_task;
+Semaphore s_semaphore(0, 1);
+
+}
+
+/**
+ * A task takes a semaphore and gives it back
+ */
+int main()
+{
+	s_semaphore.release();
+
+	s_task.start([]()
+		{
+			while (true)
+			{
+				s_semaphore.acquire();
+				s_semaphore.release();
+				s_counters[0] = s_counters[0] + 1;
+			}
+		});
+
+	run("Synchronization Processing", s_counters, 1);
+}
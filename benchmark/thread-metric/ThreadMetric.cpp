@@ -0,0 +1,87 @@
+#include "ThreadMetric.hpp"
+
+#include <Semihosting.hpp>
+
+#include <algorithm>
+
+using namespace std::chrono_literals;
+
+namespace opsy::benchmark
+{
+
+namespace
+{
+
+constexpr uint32_t kSoftwareIrq = 31; // not connected to any peripheral on the mps2-an386
+
+Task<1024> s_reporter;
+
+}
+
+void setInterruptHandler(CortexM::IsrHandler handler)
+{
+	CortexM::setIsrHandler(kSoftwareIrq, handler);
+	CortexM::setPriority(kSoftwareIrq, kInterruptPriority);
+	CortexM::enableInterrupt(kSoftwareIrq);
+}
+
+void causeInterrupt()
+{
+	CortexM::setPending(kSoftwareIrq);
+	CortexM::dataBarrier(); // the interrupt is taken before going on, as a software interrupt instruction would
+	CortexM::instructionBarrier();
+}
+
+void run(const char* name, const volatile uint32_t* counters, std::size_t count, bool balanced)
+{
+	static const char* s_name;
+	static const volatile uint32_t* s_counters;
+	static std::size_t s_count;
+	static bool s_balanced;
+
+	s_name = name;
+	s_counters = counters;
+	s_count = count;
+	s_balanced = balanced;
+
+	s_reporter.priority(Priority::Highest);
+	s_reporter.start([]()
+		{
+			uint32_t last = 0;
+			auto next = Scheduler::now();
+
+			for (uint32_t period = 1; OPSY_TM_PERIODS == 0 || period <= OPSY_TM_PERIODS; ++period)
+			{
+				next += std::chrono::seconds(OPSY_TM_PERIOD);
+				sleep_until(next);
+
+				uint32_t total = 0;
+				uint32_t minimum = UINT32_MAX;
+				uint32_t maximum = 0;
+				for (auto i = 0u; i < s_count; ++i)
+				{
+					const uint32_t value = s_counters[i];
+					total += value;
+					minimum = std::min(minimum, value);
+					maximum = std::max(maximum, value);
+				}
+
+				print("**** Thread-Metric %s Test **** Relative Time: %lu\n", s_name, static_cast<unsigned long>(period * OPSY_TM_PERIOD));
+				print("Time Period Total:  %lu\n\n", static_cast<unsigned long>(total - last));
+				last = total;
+
+				if (s_balanced && maximum - minimum > 1 + period) // every task must have run its share, but a preempted task goes behind its peers, so each report may delay one of them by a turn
+				{
+					print("ERROR: the task counters differ by more than 1, scheduling is not fair\n");
+					Semihosting::exit(false);
+				}
+			}
+
+			Semihosting::exit();
+		}, "reporter");
+
+	Scheduler::start();
+	Semihosting::exit(false); // the scheduler was already started
+}
+
+}
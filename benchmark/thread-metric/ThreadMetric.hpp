@@ -0,0 +1,89 @@
+/**
+ ******************************************************************************
+ * @file    ThreadMetric.hpp
+ * @author  Thomas Legrand
+ * @version V0.1
+ * @date    16-October-2026
+ * @brief   Thread-Metric benchmark support for OpSy
+ *
+ * 			This file contains the glue the Thread-Metric tests need on top of
+ * 			OpSy: a software triggered interrupt and the reporting @c Task that
+ * 			prints the number of operations of each period.
+ *
+ * 			They are built only from @c Task and @c sleep_for, so the tests
+ * 			measure the OpSy primitives themselves: the semaphore, message and
+ * 			memory tests use @c Semaphore, @c MessageQueue and @c MemoryPool.
+ *
+ ******************************************************************************
+ * @copyright Copyright 2019 Thomas Legrand under the MIT License
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************
+ * @see https://github.com/Otatiaro/OpSy
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <opsy.hpp>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#ifndef OPSY_TM_PERIOD
+#define OPSY_TM_PERIOD 30 // length of a reporting period, in seconds
+#endif
+
+#ifndef OPSY_TM_PERIODS
+#define OPSY_TM_PERIODS 1 // number of periods before the test exits QEMU, 0 to run forever
+#endif
+
+namespace opsy::benchmark
+{
+
+/**
+ * @brief The priority of the software interrupt, just below the @c Scheduler so it can use OpSy
+ */
+constexpr auto kInterruptPriority = IsrPriority::FromPreemptSub<kPreemptionBits>(kOpsyPreemption + 1, 0);
+
+/**
+ * @brief Sets the handler of the software interrupt and enables it at @c kInterruptPriority
+ * @param handler The interrupt service routine
+ */
+void setInterruptHandler(CortexM::IsrHandler handler);
+
+/**
+ * @brief Triggers the software interrupt
+ */
+void causeInterrupt();
+
+/**
+ * @brief Starts the reporting @c Task and the @c Scheduler, it never returns
+ * @param name The name of the test
+ * @param counters The operation counters of the test, their sum is the number of operations
+ * @param count The number of counters
+ * @param balanced @c true if the counters must not differ by more than one, for the scheduling tests
+ */
+[[noreturn]] void run(const char* name, const volatile uint32_t* counters, std::size_t count, bool balanced = false);
+
+}
@@ -0,0 +1,151 @@
+#include <opsy.hpp>
+#include <Semihosting.hpp>
+
+
+using namespace opsy;
+using namespace opsy::benchmark;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+constexpr std::size_t kWorkers = 3;
+constexpr auto kPhase = 1000ms;
+constexpr auto kPeriod = 10ms;
+constexpr uint32_t kWorkLoops = 250000; // a few ms of work each period on the mps2-an386 under -icount shift=0, the workers use about half of the processor
+constexpr uint32_t kChunkLoops = 128; // how often a task checks whether another one ran in between
+
+constexpr auto kHighPriority = static_cast<Priority>(0x10);
+constexpr auto kThreshold = static_cast<Priority>(0x20);
+constexpr Priority kWorkerPriorities[kWorkers] = { static_cast<Priority>(0x20), static_cast<Priority>(0x21), static_cast<Priority>(0x22) };
+
+struct Phase
+{
+	const char* name;
+	uint32_t switches;
+	uint32_t jobs;
+	std::size_t stack[kWorkers];
+};
+
+Task<256> s_workers[kWorkers];
+Task<256> s_high;
+Task<1024> s_control;
+
+volatile const void* s_runner = nullptr;
+volatile uint32_t s_switches = 0;
+volatile uint32_t s_jobs = 0;
+
+/**
+ * @brief Counts a context switch if another task ran since the calling one last checked
+ * @remark It sees the switches between the benchmark tasks, a preemption counts twice (to the preempting task and back)
+ */
+void checkRunner(const void* self)
+{
+	if (s_runner != self)
+	{
+		s_runner = self;
+		s_switches = s_switches + 1;
+	}
+}
+
+void work(const void* self)
+{
+	for (auto i = 0u; i < kWorkLoops; ++i)
+	{
+		if (i % kChunkLoops == 0) // a power of 2, this is a mask
+			checkRunner(self);
+		CortexM::nop();
+	}
+}
+
+/**
+ * @brief Runs the workload for @c kPhase
+ * @param threshold The preemption threshold given to the workers
+ * @remark The least important worker is released first and each following one preempts it, unless their threshold prevents it.
+ * 			The high priority task is above any threshold, it preempts in both phases
+ */
+Phase run(const char* name, Priority threshold)
+{
+	s_runner = nullptr;
+	s_switches = 0;
+	s_jobs = 0;
+
+	const auto start = Scheduler::now() + kPeriod;
+	for (auto i = 0u; i < kWorkers; ++i)
+	{
+		auto& worker = s_workers[i];
+		worker.priority(kWorkerPriorities[i]);
+		worker.preemptionThreshold(threshold);
+		worker.start([start, i]()
+			{
+				auto next = start + std::chrono::milliseconds(kWorkers - 1 - i); // released 1ms apart, the least important first
+				while (true)
+				{
+					sleep_until(next);
+					work(&s_workers[i]);
+					s_jobs = s_jobs + 1;
+					next += kPeriod;
+				}
+			}, "worker");
+	}
+
+	s_high.priority(kHighPriority);
+	s_high.start([start]()
+		{
+			auto next = start;
+			while (true)
+			{
+				sleep_until(next);
+				checkRunner(&s_high);
+				next += 5ms;
+			}
+		}, "high");
+
+	sleep_until(start + kPhase);
+
+	for (auto& worker : s_workers)
+		worker.stop();
+	s_high.stop();
+
+	Phase phase { name, s_switches, s_jobs, { } };
+	for (auto i = 0u; i < kWorkers; ++i)
+		phase.stack[i] = s_workers[i].stackHighWaterMark(); // 0 when stacks are not painted (NDEBUG without kStackPainting)
+	return phase;
+}
+
+void report(const Phase* phases, std::size_t count)
+{
+	print("{\n\t\"machine\": \"mps2-an386\",\n\t\"core_clock\": %lu,\n\t\"phases\": [\n", static_cast<unsigned long>(getCoreClock()));
+
+	for (auto i = 0u; i < count; ++i)
+	{
+		const auto& phase = phases[i];
+		print("\t\t{ \"name\": \"%s\", \"switches\": %lu, \"jobs\": %lu, \"stack_words\": [%u, %u, %u] }%s\n", phase.name,
+				static_cast<unsigned long>(phase.switches), static_cast<unsigned long>(phase.jobs),
+				static_cast<unsigned>(phase.stack[0]), static_cast<unsigned>(phase.stack[1]), static_cast<unsigned>(phase.stack[2]),
+				i + 1 < count ? "," : "");
+	}
+
+	print("\t]\n}\n");
+}
+
+}
+
+int main()
+{
+	s_control.priority(Priority::Highest);
+	s_control.start([]()
+		{
+			Phase phases[] =
+			{
+				run("preemptive", Priority::Lowest),
+				run("threshold", kThreshold),
+			};
+
+			report(phases, sizeof(phases) / sizeof(phases[0]));
+			Semihosting::exit();
+		}, "control");
+
+	Scheduler::start();
+	return -1;
+}
@@ -0,0 +1,120 @@
+#include <opsy.hpp>
+#include <Semihosting.hpp>
+
+using namespace opsy;
+using namespace opsy::benchmark;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+constexpr uint32_t kIterations = 1000; // timed waits of each phase
+constexpr std::size_t kPendingCounts[] = { 10, 100, 1000 }; // pending timeouts of each phase, not counting the waiter
+constexpr std::size_t kPhases = sizeof(kPendingCounts) / sizeof(kPendingCounts[0]);
+constexpr std::size_t kSleepers = kPendingCounts[kPhases - 1];
+constexpr auto kSleep = 1min; // far beyond the end of the benchmark, each sleeper adds its index in ms so they do not share a deadline
+constexpr auto kWaitTimeout = 10min; // after every sleeper, the sorted list has to skip them all
+
+constexpr auto kBenchPriority = static_cast<Priority>(0x10);
+constexpr auto kWaiterPriority = static_cast<Priority>(0x08);
+constexpr auto kSleeperPriority = static_cast<Priority>(0x08); // they run as soon as started, and go to sleep
+
+struct Phase
+{
+	std::size_t pending;
+	uint32_t cycles; // for all the round trips
+	bool valid;
+};
+
+Task<1024> s_bench;
+Task<256> s_waiter;
+Task<128> s_sleepers[kSleepers];
+std::size_t s_sleeperCount = 0;
+ConditionVariable s_wake;
+volatile uint32_t s_timeouts = 0;
+
+/**
+ * @brief Gets a core cycle timestamp, modulo 2^32, from the scheduler ticks and the Systick counter (QEMU does not implement the DWT)
+ */
+uint32_t timestamp()
+{
+	const uint32_t tickCycles = static_cast<uint32_t>(static_cast<uint64_t>(getCoreClock()) * duration::period::num / duration::period::den);
+
+	while (true)
+	{
+		const auto ticks = Scheduler::now().time_since_epoch().count();
+		const auto count = CortexM::systickCount();
+		if (Scheduler::now().time_since_epoch().count() == ticks) // no tick in between, the counter value belongs to this tick
+			return static_cast<uint32_t>(ticks) * tickCycles + count;
+	}
+}
+
+/**
+ * @brief Starts sleepers until @p pending timeouts are pending, each one preempts the benchmark and goes to sleep right away
+ */
+void fill(std::size_t pending)
+{
+	for (; s_sleeperCount < pending; ++s_sleeperCount)
+	{
+		auto& sleeper = s_sleepers[s_sleeperCount];
+		sleeper.priority(kSleeperPriority);
+		sleeper.start([]() { sleep_for(kSleep + duration(s_sleeperCount)); }, "sleeper"); // runs before the count is incremented
+	}
+}
+
+/**
+ * @brief Wakes the waiter @c kIterations times, it then waits again with a timeout
+ * @remark Each round trip cancels the timeout of the waiter and inserts a new one, behind every sleeper
+ */
+Phase run(std::size_t pending)
+{
+	fill(pending);
+
+	const auto timeouts = s_timeouts;
+	const auto start = timestamp();
+	for (auto i = 0u; i < kIterations; ++i)
+		s_wake.notify_one(); // switches to the waiter
+	return Phase { pending, timestamp() - start, s_timeouts == timeouts };
+}
+
+void report(const Phase* phases, std::size_t count)
+{
+	print("{\n\t\"machine\": \"mps2-an386\",\n\t\"core_clock\": %lu,\n\t\"timeout_store\": \"%s\",\n\t\"phases\": [\n",
+			static_cast<unsigned long>(getCoreClock()), kTimeoutWheel ? "wheel" : "list");
+
+	for (auto i = 0u; i < count; ++i)
+	{
+		const auto& phase = phases[i];
+		print("\t\t{ \"pending_timeouts\": %lu, \"cycles_per_wait\": %lu, \"valid\": %s }%s\n", static_cast<unsigned long>(phase.pending),
+				static_cast<unsigned long>(phase.cycles / kIterations), phase.valid ? "true" : "false", i + 1 < count ? "," : "");
+	}
+
+	print("\t]\n}\n");
+}
+
+}
+
+int main()
+{
+	s_bench.priority(kBenchPriority);
+	s_bench.start([]()
+		{
+			s_waiter.priority(kWaiterPriority);
+			s_waiter.start([]()
+				{
+					while (true)
+						if (s_wake.wait_for(kWaitTimeout) == std::cv_status::timeout) // switches back to the benchmark
+							s_timeouts = s_timeouts + 1;
+				}, "waiter");
+
+			Phase phases[kPhases];
+			for (auto i = 0u; i < kPhases; ++i)
+				phases[i] = run(kPendingCounts[i]);
+
+			report(phases, kPhases);
+			Semihosting::exit();
+		}, "bench");
+
+	Scheduler::start();
+	return -1;
+}
@@ -0,0 +1,39 @@
+#include <algorithm>
+#include <cassert>
+
+#include "CeilingMutex.hpp"
+#include "Scheduler.hpp"
+
+namespace opsy
+{
+
+void CeilingMutex::lock()
+{
+	assert(CortexM::ipsr() == 0); // cannot call in interrupt
+	auto& task = *Scheduler::s_currentTask;
+	assert(m_owner == nullptr); // its owner waited while holding it, or the ceiling is below one of its users
+	assert(task.m_basePriority >= m_ceiling); // the ceiling is below this task priority
+
+	auto previous = CortexM::setBasepri(Scheduler::kServiceCallPriority); // get a lock up to service call
+	m_owner = &task;
+	m_previousCeiling = task.m_ceiling;
+	task.m_ceiling = std::min(task.m_ceiling, m_ceiling);
+	Scheduler::inheritPriority(task); // a raise, it never switches
+	CortexM::setBasepri(previous);
+}
+
+void CeilingMutex::unlock()
+{
+	assert(CortexM::ipsr() == 0); // cannot call in interrupt
+	auto& task = *Scheduler::s_currentTask;
+	assert(m_owner == &task); // only the owner can release it
+	assert(task.m_ceiling == std::min(m_previousCeiling, m_ceiling)); // nested ceiling mutexes are released in reverse order
+
+	auto previous = CortexM::setBasepri(Scheduler::kServiceCallPriority); // get a lock up to service call
+	m_owner = nullptr;
+	task.m_ceiling = m_previousCeiling;
+	Scheduler::inheritPriority(task); // switches if a more important task is ready
+	CortexM::setBasepri(previous);
+}
+
+}
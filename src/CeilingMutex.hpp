@@ -0,0 +1,116 @@
+/**
+ ******************************************************************************
+ * @file    CeilingMutex.hpp
+ * @author  Thomas Legrand
+ * @version V0.1
+ * @date    16-October-2026
+ * @brief   Task mutex with immediate priority ceiling
+ *
+ * 			This file contains the @c CeilingMutex class, a mutual exclusion between
+ * 			@c Task using the immediate priority ceiling protocol.
+ *
+ * 			Unlike a task only @c PriorityMutex, which is a critical section and
+ * 			stops all scheduling while it is held, a @c CeilingMutex raises its
+ * 			owner to a ceiling @c Priority, that of the most important @c Task using
+ * 			it. The other users cannot preempt the owner, so it never has to wait,
+ * 			while @c Task more important than the ceiling keep running.
+ *
+ ******************************************************************************
+ * @copyright Copyright 2019 Thomas Legrand under the MIT License
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************
+ * @see https://github.com/Otatiaro/OpSy
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include "Config.hpp"
+#include "Task.hpp"
+
+namespace opsy
+{
+
+/**
+ * @brief A mutual exclusion between @c Task, with immediate priority ceiling.
+ * The owner runs at the ceiling @c Priority until it releases it
+ * @remark It satisfies the @c Lockable requirements, so it can be used with @c std::lock_guard and @c std::unique_lock
+ * @warning Only a @c Task can use it, never an interrupt service routine. The ceiling must be at least as important as every @c Task using it, and the owner must not wait
+ * 			(sleep, wait for a @c ConditionVariable or an @c InheritanceMutex) while holding it: another user could then find it taken. Nested @c CeilingMutex are released in reverse order
+ */
+class CeilingMutex
+{
+public:
+
+	/**
+	 * @brief Creates a @c CeilingMutex
+	 * @param ceiling The @c Priority of the most important @c Task using it
+	 */
+	constexpr explicit CeilingMutex(Priority ceiling) :
+			m_ceiling(ceiling)
+	{
+	}
+
+	CeilingMutex(const CeilingMutex&) = delete;
+	void operator=(const CeilingMutex&) = delete;
+
+	/**
+	 * @brief Gets the ceiling @c Priority
+	 * @return The ceiling @c Priority
+	 */
+	constexpr Priority ceiling() const
+	{
+		return m_ceiling;
+	}
+
+	/**
+	 * @brief Takes the @c CeilingMutex, raising the calling @c Task to the ceiling
+	 */
+	void lock();
+
+	/**
+	 * @brief Takes the @c CeilingMutex if it is free
+	 * @return @c true if it was taken, @c false otherwise (which only happens when it is misused, see above)
+	 */
+	bool try_lock()
+	{
+		if (m_owner != nullptr)
+			return false;
+		lock();
+		return true;
+	}
+
+	/**
+	 * @brief Releases the @c CeilingMutex, bringing the calling @c Task back to its previous @c Priority
+	 * @remark A more important @c Task that became ready in the meantime runs right away
+	 */
+	void unlock();
+
+private:
+
+	const Priority m_ceiling;
+	TaskControlBlock* m_owner = nullptr;
+	Priority m_previousCeiling = Priority::Lowest;
+};
+
+}
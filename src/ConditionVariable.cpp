@@ -18,14 +18,7 @@ void ConditionVariable::notify_one()
 
 		Hooks::conditionVariableNotifyOne(*this);
 
-		if (m_waitingList.empty())
-			return;
-		else
-		{
-			TaskControlBlock& task = m_waitingList.front();
-			m_waitingList.pop_front();
-			Scheduler::wakeUp(task, *this);
-		}
+		Scheduler::wakeUpFirst(*this);
 	}
 }
 
@@ -39,11 +32,8 @@ void ConditionVariable::notify_all()
 
 		Hooks::conditionVariableNotifyAll(*this);
 
-		while (!m_waitingList.empty())
+		while (Scheduler::wakeUpFirst(*this)) // each one leaves the list
 		{
-			TaskControlBlock& task = m_waitingList.front();
-			m_waitingList.pop_front();
-			Scheduler::wakeUp(task, *this);
 		}
 	}
 
@@ -54,14 +44,7 @@ void ConditionVariable::wait()
 	assert(CortexM::ipsr() == 0); // cannot call in interrupt
 	assert(m_mutex.priority().value_or(Scheduler::kServiceCallPriority).maskedValue<kPreemptionBits>() >= Scheduler::kServiceCallPriority.maskedValue<kPreemptionBits>()); // mutex priority can't be higher than service call
 
-	asm volatile(
-			"mov r0, %[this_ptr] \n\t"
-			"mov r1, #-1 \n\t"
-			"mov r2, #0 \n\t"
-			"svc %[immediate]"
-			:
-			: [immediate] "I" (Scheduler::ServiceCallNumber::Wait), [this_ptr] "r" (this)
-			: "r0", "r1", "r2");
+	Scheduler::serviceCall<Scheduler::ServiceCallNumber::Wait>(reinterpret_cast<uintptr_t>(this), static_cast<uintptr_t>(-1));
 }
 
 void ConditionVariable::wait(Mutex& mutex)
@@ -69,14 +52,7 @@ void ConditionVariable::wait(Mutex& mutex)
 	assert(CortexM::ipsr() == 0); // cannot call in interrupt
 	assert(m_mutex.priority().value_or(Scheduler::kServiceCallPriority).maskedValue<kPreemptionBits>() >= Scheduler::kServiceCallPriority.maskedValue<kPreemptionBits>()); // mutex priority can't be higher than service call
 
-	asm volatile(
-			"mov r0, %[this_ptr] \n\t"
-			"mov r1, #-1 \n\t"
-			"mov r2, %[mutex] \n\t"
-			"svc %[immediate]"
-			:
-			: [immediate] "I" (Scheduler::ServiceCallNumber::Wait), [this_ptr] "r" (this), [mutex] "r" (&mutex)
-			: "r0", "r1", "r2");
+	Scheduler::serviceCall<Scheduler::ServiceCallNumber::Wait>(reinterpret_cast<uintptr_t>(this), static_cast<uintptr_t>(-1), reinterpret_cast<uintptr_t>(&mutex));
 }
 
 std::cv_status ConditionVariable::wait_for(duration timeout)
@@ -84,16 +60,7 @@ std::cv_status ConditionVariable::wait_for(duration timeout)
 	assert(CortexM::ipsr() == 0); // cannot call in interrupt
 	assert(m_mutex.priority().value_or(Scheduler::kServiceCallPriority).maskedValue<kPreemptionBits>() >= Scheduler::kServiceCallPriority.maskedValue<kPreemptionBits>()); // mutex priority can't be higher than service call
 
-	uint32_t result;
-	asm volatile(
-			"mov r0, %[this_ptr] \n\t"
-			"mov r1, %[duration] \n\t"
-			"mov r2, #0 \n\t"
-			"svc %[immediate] \n\t"
-			"mov %[result], r0"
-			: [result] "=r" (result)
-			: [immediate] "I" (Scheduler::ServiceCallNumber::Wait), [this_ptr] "r" (this), [duration] "r" (timeout.count())
-			: "r0", "r1", "r2");
+	const auto result = Scheduler::serviceCall<Scheduler::ServiceCallNumber::Wait>(reinterpret_cast<uintptr_t>(this), static_cast<uintptr_t>(timeout.count()));
 
 	assert(result == 0 || result == 1); // result can only be 0 or 1 (timeout or notimeout)
 	return static_cast<std::cv_status>(result);
@@ -104,17 +71,7 @@ std::cv_status ConditionVariable::wait_for(Mutex& mutex, duration timeout)
 	assert(CortexM::ipsr() == 0); // cannot call in interrupt
 	assert(m_mutex.priority().value_or(Scheduler::kServiceCallPriority).maskedValue<kPreemptionBits>() >= Scheduler::kServiceCallPriority.maskedValue<kPreemptionBits>()); // mutex priority can't be higher than service call
 
-	uint32_t result;
-
-	asm volatile(
-			"mov r0, %[this_ptr] \n\t"
-			"mov r1, %[duration] \n\t"
-			"mov r2, %[mutex] \n\t"
-			"svc %[immediate] \n\t"
-			"mov %[result], r0"
-			: [result] "=r" (result)
-			: [immediate] "I" (Scheduler::ServiceCallNumber::Wait), [this_ptr] "r" (this), [duration] "r" (timeout.count()), [mutex] "r" (&mutex)
-			: "r0", "r1", "r2");
+	const auto result = Scheduler::serviceCall<Scheduler::ServiceCallNumber::Wait>(reinterpret_cast<uintptr_t>(this), static_cast<uintptr_t>(timeout.count()), reinterpret_cast<uintptr_t>(&mutex));
 
 	assert(result == 0 || result == 1); // result can only be 0 or 1 (timeout or notimeout)
 
@@ -131,14 +88,14 @@ std::cv_status ConditionVariable::wait_until(Mutex& mutex, time_point timeout_ti
 	return wait_for(mutex, timeout_time - Scheduler::now());
 }
 
-void ConditionVariable::addWaiting(TaskControlBlock& task)
+void ConditionVariable::addWaiting(WaitNode& node)
 {
-	m_waitingList.insertWhen(TaskControlBlock::priorityIsLower, task);
+	m_waitingList.insertWhen([](const WaitNode& left, const WaitNode& right) { return TaskControlBlock::priorityIsLower(*left.m_task, *right.m_task); }, node);
 }
 
-void ConditionVariable::removeWaiting(TaskControlBlock& task)
+void ConditionVariable::removeWaiting(WaitNode& node)
 {
-	m_waitingList.erase(task);
+	m_waitingList.erase(node);
 }
 
 }
@@ -78,6 +78,10 @@ namespace opsy
 class ConditionVariable
 {
 	friend class Scheduler;
+	friend class Semaphore;
+	friend class EventGroup;
+	template<std::size_t Size>
+	friend class WaitSet;
 
 public:
 
@@ -151,9 +155,9 @@ public:
 private:
 
 	Mutex m_mutex;
-	EmbeddedList<TaskControlBlock, TaskLists::Waiting> m_waitingList;
+	EmbeddedList<WaitNode> m_waitingList;
 
-	void addWaiting(TaskControlBlock& task);
-	void removeWaiting(TaskControlBlock& task);
+	void addWaiting(WaitNode& node);
+	void removeWaiting(WaitNode& node);
 };
 }
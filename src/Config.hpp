@@ -29,6 +29,18 @@
  * 			for the vast majority of projects. But this using allows for special
  * 			types of Mutex to be used (e.g. multi-processor semaphores).
  *
+ * 			Some @c Scheduler internals can be selected at compile time, such as
+ * 			the ready queue implementation (@c kBitmapReadyQueue), the timeout
+ * 			store (@c kTimeoutWheel) or tickless idle (@c kTicklessIdle). The POSIX
+ * 			port can run in virtual time (@c kVirtualTime). Processor time
+ * 			accounting can be enabled (@c kCpuAccounting), as well as stack
+ * 			painting to measure stack usage (@c kStackPainting), round-robin
+ * 			time slicing (@c kTimeSlicing) and earliest deadline first
+ * 			scheduling (@c kEdfScheduling).
+ * 			Defaults favor the smallest memory footprint, each one can be
+ * 			changed by defining its @c OPSY_ macro (e.g. @c OPSY_TIME_SLICING
+ * 			to @c true) in OpsyConfig.hpp or on the command line.
+ *
  * 			Finally OpSy defines the default @c duration with a time base of 1ms
  * 			and @c time_point as a 64 bit derivative of @c duration.
  * 			1ms is often use as high level time base, it is a compromise between
@@ -36,7 +48,10 @@
  * 			sleep durations.
  *
  * 			You can easily override this configuration by creating a file
- * 			named OpsyConfig.hpp in any of the include directory.
+ * 			named OpsyConfig.hpp in any of the include directory. It replaces
+ * 			the clock, priority, @c duration and @c Mutex definitions, the
+ * 			optional features above keep their default unless their macro is
+ * 			defined.
  *
  ******************************************************************************
  * @copyright Copyright 2019 Thomas Legrand under the MIT License
@@ -70,6 +85,7 @@
 
 #include "PriorityMutex.hpp"
 #include <cstdint>
+#include <cstddef>
 #include <chrono>
 #include <ratio>
 
@@ -133,6 +149,128 @@ using Mutex = PriorityMutex;
 
 #endif
 
+#ifndef OPSY_BITMAP_READY_QUEUE
+#define OPSY_BITMAP_READY_QUEUE false
+#endif
+
+/**
+ * @brief Selects the @c Scheduler ready queue implementation
+ * @remark When @c false, ready @c Task are kept in a single list sorted by @c Priority (smallest memory footprint, insertion cost grows with the number of ready @c Task)
+ * @remark When @c true, ready @c Task are kept in one FIFO per @c Priority level and a bitmap of non empty levels, insertion, removal and selection of the next @c Task are constant time (about 3KB of RAM)
+ */
+constexpr bool kBitmapReadyQueue = OPSY_BITMAP_READY_QUEUE;
+
+#ifndef OPSY_TICKLESS_IDLE
+#define OPSY_TICKLESS_IDLE false
+#endif
+
+/**
+ * @brief Enables tickless idle
+ * @remark When @c true, the Systick period is stretched up to the next timeout when the system goes idle, instead of interrupting every tick
+ * @remark Stretching and restoring the period costs a few core cycles of drift each time, which is negligible compared to the low power gain on idle heavy systems
+ */
+constexpr bool kTicklessIdle = OPSY_TICKLESS_IDLE;
+
+#ifndef OPSY_TIMEOUT_WHEEL
+#define OPSY_TIMEOUT_WHEEL false
+#endif
+
+/**
+ * @brief Selects the @c Scheduler timeout store implementation
+ * @remark When @c false, @c Task waiting for a timeout are kept in a single sorted list (smallest memory footprint, insertion cost grows with the number of pending timeouts)
+ * @remark When @c true, they are kept in a hierarchical timing wheel, insertion and cancellation are constant time and each tick only processes the slots that come up (about 1.5KB of RAM)
+ */
+constexpr bool kTimeoutWheel = OPSY_TIMEOUT_WHEEL;
+
+#ifndef OPSY_VIRTUAL_TIME
+#define OPSY_VIRTUAL_TIME false
+#endif
+
+/**
+ * @brief Runs the POSIX port in virtual time (ignored on target)
+ * @remark When @c true, the simulated core clock only advances when the system is idle (straight to the next Systick interrupt) or when code calls @c CortexM::elapse, instead of following the host clock
+ * @remark Execution is then deterministic and long scenarios run much faster than real time, especially with @c kTicklessIdle where idle periods jump to the next timeout
+ */
+constexpr bool kVirtualTime = OPSY_VIRTUAL_TIME;
+
+#ifndef OPSY_CPU_ACCOUNTING
+#define OPSY_CPU_ACCOUNTING false
+#endif
+
+/**
+ * @brief Enables processor time accounting
+ * @remark When @c true, the core cycles used by each @c Task, the idle task and the Systick, service call and PendSV handlers are accumulated with the DWT cycle counter (see @c TaskControlBlock::cpuUsage and @c Scheduler::cpuUsage)
+ * @remark It costs a few cycles in each kernel handler, and a walk of all @c Task once per @c kCpuLoadWindow, so it can stay enabled in production
+ * @remark It is needed by execution budgets (see @c TaskControlBlock::budget)
+ */
+constexpr bool kCpuAccounting = OPSY_CPU_ACCOUNTING;
+
+#ifndef OPSY_CPU_LOAD_WINDOW
+#define OPSY_CPU_LOAD_WINDOW duration(1000)
+#endif
+
+/**
+ * @brief The length of the sliding window used to compute @c CpuUsage::load
+ */
+constexpr duration kCpuLoadWindow = OPSY_CPU_LOAD_WINDOW;
+
+#ifndef OPSY_TIME_SLICING
+#define OPSY_TIME_SLICING false
+#endif
+
+/**
+ * @brief Enables round-robin time slicing between ready @c Task of the same @c Priority
+ * @remark When @c true, a @c Task that ran for its time slice (see @c timeSlice) goes behind the other ready @c Task of its @c Priority, if any, this is checked on each Systick
+ * @remark When @c false, a @c Task runs until it blocks, yields or is preempted by a more important @c Task
+ */
+constexpr bool kTimeSlicing = OPSY_TIME_SLICING;
+
+#ifndef OPSY_TIME_SLICE
+#define OPSY_TIME_SLICE(priority) duration(10)
+#endif
+
+/**
+ * @brief Gets the time slice of the @c Task of a @c Priority level, when @c kTimeSlicing is enabled
+ * @param priority The value of the @c Priority level
+ * @return The time slice, a @c Task preempted by a more important one starts a new time slice when it resumes
+ */
+constexpr duration timeSlice([[maybe_unused]] uint8_t priority)
+{
+	return OPSY_TIME_SLICE(priority);
+}
+
+#ifndef OPSY_EDF_SCHEDULING
+#define OPSY_EDF_SCHEDULING false
+#endif
+
+/**
+ * @brief Enables earliest deadline first scheduling between ready @c Task of the same @c Priority
+ * @remark When @c true, the ready @c Task of a @c Priority level run by order of their deadline (see @c TaskControlBlock::relativeDeadline), those without deadline after them.
+ * 			Levels are still served by @c Priority, so giving the deadline driven @c Task the same @c Priority lets them use up to the whole processor, while more important ones, @c CeilingMutex and @c InheritanceMutex work as before
+ * @remark When @c false, deadlines are not tracked, @c Task of the same @c Priority run in the order they became ready
+ */
+constexpr bool kEdfScheduling = OPSY_EDF_SCHEDULING;
+
+#ifndef OPSY_STACK_PAINTING
+#define OPSY_STACK_PAINTING false
+#endif
+
+/**
+ * @brief Paints the stacks in release builds too, so their high-water mark can be measured (debug builds always paint them)
+ * @remark When @c true, @c Task stacks are filled when they start, which costs a few cycles per word of stack, see @c TaskControlBlock::stackHighWaterMark
+ */
+constexpr bool kStackPainting = OPSY_STACK_PAINTING;
+
+#ifndef OPSY_MAIN_STACK_SIZE
+#define OPSY_MAIN_STACK_SIZE 0
+#endif
+
+/**
+ * @brief The size of the main stack (used by interrupt service routines once the @c Scheduler started), in @c uint32_t increment
+ * @remark It is painted when the @c Scheduler starts if stacks are painted, @c 0 if unknown (the main stack is then not measured), see @c Scheduler::mainStackHighWaterMark
+ */
+constexpr std::size_t kMainStackSize = OPSY_MAIN_STACK_SIZE;
+
 /**
  * @brief The type used to describe a time point
  */
@@ -48,6 +48,14 @@
 #include "Config.hpp"
 #include "IsrPriority.hpp"
 
+#if defined(__linux__) && !defined(OPSY_POSIX)
+#define OPSY_POSIX ///< Selects the POSIX port, which runs OpSy as a normal Linux process
+#endif
+
+#if defined(OPSY_POSIX)
+#include "posix/CortexM.hpp"
+#else
+
 namespace
 {
 
@@ -205,6 +213,66 @@ public:
 		return MemoryRegister<uint32_t>(SystickLoadAddress).get() - MemoryRegister<uint32_t>(SystickValAddress).get();
 	}
 
+	/**
+	 * @brief Gets the raw Systick counter value
+	 * @return The current Systick value, which decrements down to @c 0 before being reloaded
+	 */
+	static uint32_t systickValue()
+	{
+		return MemoryRegister<uint32_t>(SystickValAddress).get();
+	}
+
+	/**
+	 * @brief Gets the maximum number of cycles a single Systick period can last
+	 * @return The maximum number of cycles a single Systick period can last
+	 */
+	static constexpr uint32_t systickMaxReload()
+	{
+		return SystickReloadMask + 1;
+	}
+
+	/**
+	 * @brief Stops the Systick counter, keeping its current value
+	 */
+	static void stopSystick()
+	{
+		MemoryRegister<uint32_t>(SystickCtrlAddress).set(SystickCtrlClkSource | SystickCtrlTickInt);
+	}
+
+	/**
+	 * @brief Resumes the Systick counter from its current value
+	 */
+	static void resumeSystick()
+	{
+		MemoryRegister<uint32_t>(SystickCtrlAddress).set(SystickCtrlClkSource | SystickCtrlTickInt | SystickCtrlEnable);
+	}
+
+	/**
+	 * @brief Restarts the Systick counter for a single period of @p first cycles, followed by periods of @p reload cycles
+	 * @param first The length of the first period, in cycles
+	 * @param reload The length of the following periods, in cycles
+	 * @remark The counter loads @p first on the clock following its restart, @p reload is then written to be used at the next reload
+	 */
+	static void restartSystick(uint32_t first, uint32_t reload)
+	{
+		assert(first != 0 && reload != 0);
+		assert(first - 1 <= SystickReloadMask && reload - 1 <= SystickReloadMask);
+		MemoryRegister<uint32_t>(SystickCtrlAddress).set(SystickCtrlClkSource | SystickCtrlTickInt); // stop timer
+		MemoryRegister<uint32_t>(SystickLoadAddress).set(first - 1); // set the first period
+		MemoryRegister<uint32_t>(SystickValAddress).set(0); // reset the counter, it will load the first period on next clock
+		MemoryRegister<uint32_t>(SystickCtrlAddress).set(SystickCtrlClkSource | SystickCtrlTickInt | SystickCtrlEnable); // start the timer
+		MemoryRegister<uint32_t>(SystickLoadAddress).set(reload - 1); // and set the following periods
+	}
+
+	/**
+	 * @brief Checks if the Systick interrupt is pending
+	 * @return @c true if the Systick interrupt is pending, @c false otherwise
+	 */
+	static inline bool isSystickPending()
+	{
+		return (MemoryRegister<uint32_t>(IcsrAddress).get() & IcsrPendStSet) != 0;
+	}
+
 	/**
 	 * @brief Enables a peripheral interrupt
 	 * @param irq The interrupt request to enable
@@ -749,11 +817,87 @@ public:
 	    return result;
 	}
 
+	/**
+	 * @brief The result of a context switch: the stack pointer to restore (low word) and the @c BASEPRI value to restore (high word)
+	 * @remark It is returned in R0 and R1, which is what the @c PendSV handler expects
+	 */
+	using SwitchResult = uint64_t;
+
+	/**
+	 * @brief Builds a @c SwitchResult
+	 * @param stackPointer The stack pointer to restore
+	 * @param basepri The @c BASEPRI value to restore
+	 * @return The @c SwitchResult
+	 */
+	static inline SwitchResult switchResult(uint32_t* stackPointer, uint32_t basepri)
+	{
+		return reinterpret_cast<uint64_t>(stackPointer) | (static_cast<uint64_t>(basepri) << 32);
+	}
+
+	/**
+	 * @brief Triggers a service call (@c SVC instruction)
+	 * @tparam Number The service call number, encoded in the @c SVC instruction
+	 * @param r0 The first argument, in R0
+	 * @param r1 The second argument, in R1
+	 * @param r2 The third argument, in R2
+	 * @return The value of R0 when the service call returns
+	 */
+	template<uint8_t Number>
+	static inline __attribute__((always_inline)) uintptr_t serviceCall(uintptr_t r0 = 0, uintptr_t r1 = 0, uintptr_t r2 = 0)
+	{
+		register uintptr_t a0 asm("r0") = r0;
+		register uintptr_t a1 asm("r1") = r1;
+		register uintptr_t a2 asm("r2") = r2;
+		asm volatile("svc %[immediate]"
+				: "+r" (a0)
+				: [immediate] "I" (Number), "r" (a1), "r" (a2)
+				: "memory");
+		return a0;
+	}
+
+	/**
+	 * @brief Counts the leading zero bits of a value, using the @c CLZ instruction
+	 * @param value The value to count leading zeros of
+	 * @return The number of leading zero bits, from @c 0 (most significant bit set) to @c 32 (@p value is @c 0)
+	 */
+	static constexpr inline uint8_t countLeadingZeros(uint32_t value)
+	{
+		return value == 0 ? 32 : static_cast<uint8_t>(__builtin_clz(value));
+	}
+
+	/**
+	 * @brief Counts the trailing zero bits of a value, using the @c RBIT and @c CLZ instructions
+	 * @param value The value to count trailing zeros of
+	 * @return The number of trailing zero bits, from @c 0 (least significant bit set) to @c 32 (@p value is @c 0)
+	 */
+	static constexpr inline uint8_t countTrailingZeros(uint32_t value)
+	{
+		return value == 0 ? 32 : static_cast<uint8_t>(__builtin_ctz(value));
+	}
+
+	/**
+	 * @brief Enables the Data Watchpoint and Trace (DWT) cycle counter
+	 * @remark The counter is not implemented on every core, nor by every simulator, in which case it stays at @c 0
+	 */
+	static inline void enableCycleCount()
+	{
+		MemoryRegister<uint32_t>(DemcrAddress).set(MemoryRegister<uint32_t>(DemcrAddress).get() | DemcrTrcEna);
+		MemoryRegister<uint32_t>(DwtCtrlAddress).set(MemoryRegister<uint32_t>(DwtCtrlAddress).get() | DwtCtrlCycCntEna);
+	}
+
+	/**
+	 * @brief Gets the DWT cycle counter
+	 * @return The number of core cycles elapsed since the counter was enabled, modulo 2^32
+	 */
 	static inline uint32_t cycleCount()
 	{
 		return MemoryRegister<uint32_t>(CycCntAddress).get();
 	}
 
+	/**
+	 * @brief Sets the DWT cycle counter
+	 * @param value The new value of the cycle counter
+	 */
 	static inline void cycleCount(uint32_t value)
 	{
 		MemoryRegister<uint32_t>(CycCntAddress).set(value);
@@ -763,7 +907,9 @@ private:
 
 	static constexpr const uint32_t DwtAddress = 0xE0001000;
 
+	static constexpr uint32_t DwtCtrlAddress = DwtAddress;
 	static constexpr uint32_t CycCntAddress = DwtAddress + 0x004;
+	static constexpr uint32_t DwtCtrlCycCntEna = 1 << 0;
 
 	static constexpr const uint32_t ScsAddress = 0xE000E000;
 
@@ -777,6 +923,8 @@ private:
 	static constexpr uint32_t AircrAddress = ScbAddress + 0x0C;
 	static constexpr uint32_t IcsrAddress = ScbAddress + 0x04;
 	static constexpr uint32_t ScbCpacrAddress = ScbAddress + 0x88;
+	static constexpr uint32_t DemcrAddress = ScsAddress + 0x0DFC;
+	static constexpr uint32_t DemcrTrcEna = 1 << 24;
 
 	static constexpr uint32_t SystickCtrlAddress = SystickAddress;
 	static constexpr uint32_t SystickLoadAddress = SystickAddress + 0x04;
@@ -808,6 +956,10 @@ private:
 	static constexpr uint32_t IcsrPendSvClrMsk = 1 << IcsrPendSvClrPos;
 	static constexpr uint32_t IcsrPendSvClr = IcsrPendSvClrMsk;
 
+	static constexpr std::size_t IcsrPendStSetPos = 26;
+	static constexpr uint32_t IcsrPendStSetMsk = 1 << IcsrPendStSetPos;
+	static constexpr uint32_t IcsrPendStSet = IcsrPendStSetMsk;
+
 	static constexpr uint32_t ScbCpacrEnableFpu = 0b1111 << 20;
 
 	static constexpr std::size_t SystickReloadBits = 24;
@@ -837,3 +989,5 @@ private:
 	}
 };
 }
+
+#endif
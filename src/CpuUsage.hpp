@@ -0,0 +1,93 @@
+/**
+ ******************************************************************************
+ * @file    CpuUsage.hpp
+ * @author  Thomas Legrand
+ * @version V0.1
+ * @date    16-October-2026
+ * @brief   Processor time accounting
+ *
+ * 			This file contains the processor time accounting types.
+ *
+ * 			@c CpuAccount accumulates the core cycles used by a @c Task, the idle
+ * 			task or a kernel handler, @c CpuUsage is the snapshot given to the
+ * 			application by @c TaskControlBlock::cpuUsage and @c Scheduler::cpuUsage.
+ *
+ * 			Accounting is enabled with @c kCpuAccounting.
+ *
+ ******************************************************************************
+ * @copyright Copyright 2019 Thomas Legrand under the MIT License
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************
+ * @see https://github.com/Otatiaro/OpSy
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace opsy
+{
+
+/**
+ * @brief A snapshot of the processor time used by a @c Task, the idle task or a kernel handler
+ */
+struct CpuUsage
+{
+	uint64_t cycles; ///< Core cycles used since the @c Scheduler started
+	uint32_t activations; ///< Number of times it got the processor
+	uint16_t load; ///< Share of the processor used over the last @c kCpuLoadWindow, in per mille
+};
+
+/**
+ * @brief Accumulates the processor time used by a @c Task, the idle task or a kernel handler
+ * @remark It is only updated by the @c Scheduler, from its handlers
+ */
+class CpuAccount
+{
+	friend class Scheduler;
+
+public:
+
+	constexpr CpuAccount() = default;
+
+private:
+
+	uint64_t m_cycles = 0;
+	uint64_t m_windowStart = 0; // m_cycles when the current load window started
+	uint32_t m_previousWindow = 0; // cycles used during the previous load window
+	uint32_t m_activations = 0;
+
+	inline void charge(uint32_t cycles)
+	{
+		m_cycles += cycles;
+	}
+
+	inline void roll()
+	{
+		m_previousWindow = static_cast<uint32_t>(m_cycles - m_windowStart);
+		m_windowStart = m_cycles;
+	}
+};
+
+}
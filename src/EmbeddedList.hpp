@@ -420,9 +420,10 @@ public:
 	 * @param other The other @c EmbeddedList to move data from
 	 */
 	explicit EmbeddedList(EmbeddedList&& other) :
-			m_first(other.m_first), m_size(other.m_size)
+			m_first(other.m_first), m_last(other.m_last), m_size(other.m_size)
 	{
 		other.m_first = nullptr;
+		other.m_last = nullptr;
 		other.m_size = 0;
 	}
 
@@ -434,8 +435,10 @@ public:
 	constexpr EmbeddedList& operator=(EmbeddedList&& other)
 	{
 		m_first = other.m_first;
+		m_last = other.m_last;
 		m_size = other.m_size;
 		other.m_first = nullptr;
+		other.m_last = nullptr;
 		other.m_size = 0;
 		return *this;
 	}
@@ -465,6 +468,7 @@ public:
 		}
 
 		m_first = nullptr;
+		m_last = nullptr;
 		m_size = 0;
 	}
 
@@ -572,11 +576,33 @@ public:
 
 		if (!empty())
 			begin().previous(&item);
+		else
+			m_last = &item;
 
 		m_first = &item;
 		++m_size;
 	}
 
+	/**
+	 * @brief Add an @c Item to the end of the @c EmbeddedList
+	 * @param item The @c Item to add to the end of the @c EmbeddedList
+	 */
+	void push_back(Item& item)
+	{
+		assert(iterator(&item).is_free());
+
+		if (empty())
+		{
+			push_front(item);
+			return;
+		}
+
+		iterator(&item).previous(m_last);
+		iterator(m_last).next(&item);
+		m_last = &item;
+		++m_size;
+	}
+
 	/**
 	 * @brief Removes the first @c Item from the @c EmbeddedList
 	 */
@@ -593,7 +619,8 @@ public:
 
 		if (!empty())
 			begin().previous(nullptr);
-
+		else
+			m_last = nullptr;
 	}
 
 	/**
@@ -606,6 +633,16 @@ public:
 		return *m_first;
 	}
 
+	/**
+	 * @brief Gets the last @c Item in the @c EmbeddedList
+	 * @return The last @c Item in the @c EmbeddedList
+	 */
+	Item& back()
+	{
+		assert(!empty());
+		return *m_last;
+	}
+
 	/**
 	 * @brief Removes an item from the @c EmbeddedList
 	 * @param item The @c Item to remove from the @c EmbeddedList
@@ -624,7 +661,7 @@ public:
 			{
 				if (m_first == i.ptr())
 				{
-					m_first = nullptr;
+					m_first = m_last = nullptr;
 					--m_size;
 				}
 				return end();
@@ -644,6 +681,8 @@ public:
 			iterator(i.previous()).next(next); // stitch first side
 			if (next != nullptr)
 				iterator(next).previous(i.previous()); // stitch other side
+			else
+				m_last = i.previous(); // removed the last element
 			i.reset();
 			--m_size;
 			return iterator(next);
@@ -660,7 +699,6 @@ public:
 	{
 		assert(iterator(&item).is_free());
 
-		++m_size;
 		if (empty() || previous.ptr() == nullptr) // list is empty or previous is null (before the list)
 		{
 			push_front(item);
@@ -676,7 +714,10 @@ public:
 		previous.next(i.ptr()); // and stitch both sides
 		if (next != nullptr)
 			iterator(next).previous(i.ptr());
+		else
+			m_last = i.ptr(); // inserted after the last element
 
+		++m_size;
 		return iterator(&item);
 	}
 
@@ -713,6 +754,7 @@ public:
 private:
 
 	Item* m_first = nullptr;
+	Item* m_last = nullptr;
 	size_type m_size = 0;
 
 };
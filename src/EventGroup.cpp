@@ -0,0 +1,105 @@
+#include <mutex>
+#include <cassert>
+
+#include "EventGroup.hpp"
+#include "Scheduler.hpp"
+
+namespace opsy
+{
+
+uint32_t EventGroup::set(uint32_t flags)
+{
+	while (true)
+	{
+		const auto value = CortexM::loadExclusive(&m_flags);
+		if (!m_waiters.m_waitingList.empty()) // a Task waits, it may be satisfied
+			break;
+		if (CortexM::storeExclusive(&m_flags, value | flags) == 0) // a Task that starts to wait in between makes it fail
+			return value | flags;
+	}
+
+	std::lock_guard<Mutex> guard(m_guard);
+	const auto value = m_flags | flags;
+	uint32_t cleared = 0;
+
+	Scheduler::wakeUpSatisfied(m_waiters, [value, &cleared](TaskControlBlock& task)
+		{
+			if (!isSatisfied(value, task.m_eventFlags, task.m_eventAll))
+				return false;
+			if (task.m_eventClear)
+				cleared |= task.m_eventFlags;
+			task.m_eventFlags = value; // what its wait returns
+			return true;
+		});
+
+	m_flags = value & ~cleared; // every satisfied Task sees the flags, even those another one clears
+	return m_flags;
+}
+
+uint32_t EventGroup::clear(uint32_t flags)
+{
+	while (true)
+	{
+		const auto value = CortexM::loadExclusive(&m_flags);
+		if (CortexM::storeExclusive(&m_flags, value & ~flags) == 0)
+			return value;
+	}
+}
+
+uint32_t EventGroup::wait(uint32_t flags, Mode mode, bool clear)
+{
+	const auto value = wait(flags, std::nullopt, mode == Mode::All, clear);
+	assert(value.has_value()); // without time limit, the wait only ends when it is satisfied
+	return value.value_or(0);
+}
+
+std::optional<uint32_t> EventGroup::wait_for(uint32_t flags, duration timeout, Mode mode, bool clear)
+{
+	return wait(flags, Scheduler::now() + timeout, mode == Mode::All, clear);
+}
+
+std::optional<uint32_t> EventGroup::wait_until(uint32_t flags, time_point timeout_time, Mode mode, bool clear)
+{
+	return wait(flags, timeout_time, mode == Mode::All, clear);
+}
+
+std::optional<uint32_t> EventGroup::wait(uint32_t flags, std::optional<time_point> timeout_time, bool all, bool clear)
+{
+	assert(CortexM::ipsr() == 0); // cannot wait in interrupt
+	assert(flags != 0); // such a wait is never satisfied
+
+	std::unique_lock<Mutex> guard(m_guard);
+
+	const auto value = m_flags;
+	if (isSatisfied(value, flags, all))
+	{
+		if (clear)
+			m_flags = value & ~flags;
+		return value;
+	}
+
+	const auto now = Scheduler::now();
+	if (timeout_time.has_value() && timeout_time.value() <= now)
+		return std::nullopt;
+
+	auto& task = *Scheduler::s_currentTask;
+	task.m_eventFlags = flags;
+	task.m_eventAll = all;
+	task.m_eventClear = clear;
+
+	const auto timeout = timeout_time.has_value() ? timeout_time.value() - now : duration(-1);
+	const auto result = Scheduler::serviceCall<Scheduler::ServiceCallNumber::Wait>(reinterpret_cast<uintptr_t>(&m_waiters), static_cast<uintptr_t>(timeout.count()),
+			reinterpret_cast<uintptr_t>(&m_guard));
+
+	if (result == static_cast<uintptr_t>(std::cv_status::no_timeout)) // released by set, which applied the clear
+		return task.m_eventFlags;
+
+	const auto late = m_flags; // timed out, but the flags may have been set since
+	if (!isSatisfied(late, flags, all))
+		return std::nullopt;
+	if (clear)
+		m_flags = late & ~flags;
+	return late;
+}
+
+}
@@ -0,0 +1,163 @@
+/**
+ ******************************************************************************
+ * @file    EventGroup.hpp
+ * @author  Thomas Legrand
+ * @version V0.1
+ * @date    16-October-2026
+ * @brief   Event flags, set from interrupt service routines and waited for by tasks
+ *
+ * 			This file contains the @c EventGroup class, 32 event flags that
+ * 			interrupt service routines and @c Task set and clear, and that @c Task
+ * 			wait for, any or all of a mask, with a time limit.
+ *
+ * 			Setting flags no @c Task waits for is a single exclusive load and
+ * 			store. Otherwise every @c Task whose wait is satisfied is released in
+ * 			a single pass, with a single switch request.
+ *
+ ******************************************************************************
+ * @copyright Copyright 2019 Thomas Legrand under the MIT License
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************
+ * @see https://github.com/Otatiaro/OpSy
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <optional>
+
+#include "Config.hpp"
+#include "ConditionVariable.hpp"
+
+namespace opsy
+{
+
+/**
+ * @brief A group of 32 event flags.
+ * Interrupt service routines and @c Task set and clear flags, a @c Task waits for any or all of a mask of flags, e.g. "DMA done and buffer free" or "any of these interrupt sources"
+ * @remark A wait may clear the flags it waited for when it is satisfied, so each event is handled once
+ * @warning Only interrupt service routines at or below @c kPriority can use it
+ */
+class EventGroup
+{
+public:
+
+	/**
+	 * @brief The most important @c IsrPriority allowed to use an @c EventGroup, the one of the @c Mutex protecting the waiting @c Task, just below the @c Scheduler
+	 */
+	static constexpr auto kPriority = IsrPriority::FromPreemptSub<kPreemptionBits>(kOpsyPreemption + 1, 0);
+
+	/**
+	 * @brief What satisfies a wait
+	 */
+	enum class Mode
+		: uint8_t
+		{
+			Any, ///< Any of the flags is set
+		All, ///< All the flags are set
+	};
+
+	/**
+	 * @brief Creates an @c EventGroup
+	 * @param flags The flags initially set
+	 */
+	constexpr explicit EventGroup(uint32_t flags = 0) :
+			m_flags(flags)
+	{
+	}
+
+	EventGroup(const EventGroup&) = delete;
+	void operator=(const EventGroup&) = delete;
+
+	/**
+	 * @brief Sets flags, releasing every waiting @c Task it satisfies
+	 * @param flags The flags to set
+	 * @return The flags once set, and cleared by the released @c Task that asked to
+	 * @remark It can be called from a @c Task or an interrupt service routine, when no @c Task waits it does not involve the @c Scheduler
+	 */
+	uint32_t set(uint32_t flags);
+
+	/**
+	 * @brief Clears flags
+	 * @param flags The flags to clear
+	 * @return The flags before they were cleared
+	 * @remark It can be called from a @c Task or an interrupt service routine, it never involves the @c Scheduler
+	 */
+	uint32_t clear(uint32_t flags);
+
+	/**
+	 * @brief Gets the flags currently set
+	 * @return The flags currently set
+	 */
+	uint32_t flags() const
+	{
+		return m_flags;
+	}
+
+	/**
+	 * @brief Waits for flags, as long as needed
+	 * @param flags The flags to wait for, not @c 0
+	 * @param mode Whether any or all of @p flags satisfy the wait
+	 * @param clear @c true to clear @p flags when the wait is satisfied
+	 * @return The flags that satisfied the wait, before they were cleared
+	 * @warning This should only be called from @c Task
+	 */
+	uint32_t wait(uint32_t flags, Mode mode = Mode::Any, bool clear = false);
+
+	/**
+	 * @brief Waits for flags, at most @p timeout
+	 * @param flags The flags to wait for, not @c 0
+	 * @param timeout The time limit of the wait
+	 * @param mode Whether any or all of @p flags satisfy the wait
+	 * @param clear @c true to clear @p flags when the wait is satisfied
+	 * @return The flags that satisfied the wait, before they were cleared, or @c std::nullopt if @p timeout elapsed first
+	 * @warning This should only be called from @c Task
+	 */
+	std::optional<uint32_t> wait_for(uint32_t flags, duration timeout, Mode mode = Mode::Any, bool clear = false);
+
+	/**
+	 * @brief Waits for flags, at most up to @p timeout_time
+	 * @param flags The flags to wait for, not @c 0
+	 * @param timeout_time The time limit of the wait
+	 * @param mode Whether any or all of @p flags satisfy the wait
+	 * @param clear @c true to clear @p flags when the wait is satisfied
+	 * @return The flags that satisfied the wait, before they were cleared, or @c std::nullopt if @p timeout_time was reached first
+	 * @warning This should only be called from @c Task
+	 */
+	std::optional<uint32_t> wait_until(uint32_t flags, time_point timeout_time, Mode mode = Mode::Any, bool clear = false);
+
+private:
+
+	Mutex m_guard { kPriority }; // nothing may set flags between the check and the wait
+	ConditionVariable m_waiters;
+	uint32_t m_flags; // changed by exclusive load and store, or with m_guard locked when a Task waits
+
+	static constexpr bool isSatisfied(uint32_t value, uint32_t flags, bool all)
+	{
+		return all ? (value & flags) == flags : (value & flags) != 0;
+	}
+
+	std::optional<uint32_t> wait(uint32_t flags, std::optional<time_point> timeout_time, bool all, bool clear);
+};
+
+}
@@ -165,6 +165,47 @@ namespace opsy
 		static constexpr void taskReady([[maybe_unused]] TaskControlBlock& task)
 		{}
 
+		/**
+		 * @brief Called when a @c Task ends an activation after its deadline, its EDF one when @c kEdfScheduling is enabled or the one of its @c Periodic
+		 * @param task The @c Task that missed its deadline, with @c kEdfScheduling @c TaskControlBlock::deadline still gives the deadline it missed
+		 * @remark An OpsyHooks.hpp may leave it out, see @c OptionalHooks
+		 */
+		static constexpr void deadlineMissed([[maybe_unused]] TaskControlBlock& task)
+		{}
+
+		/**
+		 * @brief Called when a @c Task ends an activation of its @c Periodic after the next release, it overran its period
+		 * @param task The @c Task that overran its period
+		 * @remark An OpsyHooks.hpp may leave it out, see @c OptionalHooks
+		 */
+		static constexpr void periodOverrun([[maybe_unused]] TaskControlBlock& task)
+		{}
+
+		/**
+		 * @brief Called when a @c Task used its execution budget and is parked until its budget period ends
+		 * @param task The parked @c Task
+		 * @remark An OpsyHooks.hpp may leave it out, see @c OptionalHooks
+		 */
+		static constexpr void budgetExhausted([[maybe_unused]] TaskControlBlock& task)
+		{}
+
+		/**
+		 * @brief Called when the job of a time-triggered @c Task runs longer than the budget of its @c ScheduleEntry
+		 * @param task The @c Task that overran its budget
+		 * @remark It is called from the Systick while the job still runs, or when it ends
+		 * @remark An OpsyHooks.hpp may leave it out, see @c OptionalHooks
+		 */
+		static constexpr void scheduleOverrun([[maybe_unused]] TaskControlBlock& task)
+		{}
+
+		/**
+		 * @brief Called when an entry of a @c ScheduleTable cannot be dispatched, because a job still runs or its @c Task does not wait for a dispatch
+		 * @param task The @c Task of the entry
+		 * @remark An OpsyHooks.hpp may leave it out, see @c OptionalHooks
+		 */
+		static constexpr void dispatchMissed([[maybe_unused]] TaskControlBlock& task)
+		{}
+
 		/**
 		 * @brief Called when a @c Task name has changed
 		 * @param task The @c Task that has changed name
@@ -287,3 +328,110 @@ namespace opsy
 
 #endif
 
+namespace opsy
+{
+	/**
+	 * @brief Calls the hooks added after the first release of OpSy, so an OpsyHooks.hpp written before them still compiles
+	 * @remark A custom @c Hooks class only defines the ones it uses among @c deadlineMissed, @c periodOverrun, @c budgetExhausted, @c scheduleOverrun and @c dispatchMissed, the others do nothing
+	 */
+	class OptionalHooks
+	{
+	public:
+		/**
+		 * @brief Calls @c Hooks::deadlineMissed if it is defined
+		 * @param task The @c Task given to the hook
+		 */
+		static void deadlineMissed(TaskControlBlock& task)
+		{
+			deadlineMissed<Hooks>(task, 0);
+		}
+
+		/**
+		 * @brief Calls @c Hooks::periodOverrun if it is defined
+		 * @param task The @c Task given to the hook
+		 */
+		static void periodOverrun(TaskControlBlock& task)
+		{
+			periodOverrun<Hooks>(task, 0);
+		}
+
+		/**
+		 * @brief Calls @c Hooks::budgetExhausted if it is defined
+		 * @param task The @c Task given to the hook
+		 */
+		static void budgetExhausted(TaskControlBlock& task)
+		{
+			budgetExhausted<Hooks>(task, 0);
+		}
+
+		/**
+		 * @brief Calls @c Hooks::scheduleOverrun if it is defined
+		 * @param task The @c Task given to the hook
+		 */
+		static void scheduleOverrun(TaskControlBlock& task)
+		{
+			scheduleOverrun<Hooks>(task, 0);
+		}
+
+		/**
+		 * @brief Calls @c Hooks::dispatchMissed if it is defined
+		 * @param task The @c Task given to the hook
+		 */
+		static void dispatchMissed(TaskControlBlock& task)
+		{
+			dispatchMissed<Hooks>(task, 0);
+		}
+
+	private:
+
+		template<typename H>
+		static auto deadlineMissed(TaskControlBlock& task, int) -> decltype(H::deadlineMissed(task))
+		{
+			H::deadlineMissed(task);
+		}
+
+		template<typename H>
+		static void deadlineMissed([[maybe_unused]] TaskControlBlock& task, long)
+		{}
+
+		template<typename H>
+		static auto periodOverrun(TaskControlBlock& task, int) -> decltype(H::periodOverrun(task))
+		{
+			H::periodOverrun(task);
+		}
+
+		template<typename H>
+		static void periodOverrun([[maybe_unused]] TaskControlBlock& task, long)
+		{}
+
+		template<typename H>
+		static auto budgetExhausted(TaskControlBlock& task, int) -> decltype(H::budgetExhausted(task))
+		{
+			H::budgetExhausted(task);
+		}
+
+		template<typename H>
+		static void budgetExhausted([[maybe_unused]] TaskControlBlock& task, long)
+		{}
+
+		template<typename H>
+		static auto scheduleOverrun(TaskControlBlock& task, int) -> decltype(H::scheduleOverrun(task))
+		{
+			H::scheduleOverrun(task);
+		}
+
+		template<typename H>
+		static void scheduleOverrun([[maybe_unused]] TaskControlBlock& task, long)
+		{}
+
+		template<typename H>
+		static auto dispatchMissed(TaskControlBlock& task, int) -> decltype(H::dispatchMissed(task))
+		{
+			H::dispatchMissed(task);
+		}
+
+		template<typename H>
+		static void dispatchMissed([[maybe_unused]] TaskControlBlock& task, long)
+		{}
+	};
+}
@@ -0,0 +1,68 @@
+#include <mutex>
+#include <cassert>
+
+#include "InheritanceMutex.hpp"
+#include "Scheduler.hpp"
+
+namespace opsy
+{
+
+void InheritanceMutex::lock()
+{
+	[[maybe_unused]] const bool taken = acquire(std::nullopt);
+	assert(taken); // without time limit, the wait only ends when it is handed over
+}
+
+bool InheritanceMutex::try_lock()
+{
+	return acquire(Startup); // already elapsed, do not wait
+}
+
+bool InheritanceMutex::try_lock_for(duration timeout)
+{
+	return acquire(Scheduler::now() + timeout);
+}
+
+bool InheritanceMutex::try_lock_until(time_point timeout_time)
+{
+	return acquire(timeout_time);
+}
+
+void InheritanceMutex::unlock()
+{
+	assert(CortexM::ipsr() == 0); // cannot call in interrupt
+	assert(m_owner == Scheduler::s_currentTask); // only the owner can release it
+	Scheduler::releaseMutex(*this);
+}
+
+bool InheritanceMutex::acquire(std::optional<time_point> timeout_time)
+{
+	assert(CortexM::ipsr() == 0); // cannot call in interrupt
+
+	std::unique_lock<Mutex> guard(m_guard);
+	auto& task = *Scheduler::s_currentTask;
+	assert(m_owner != &task); // it is not recursive
+
+	if (m_owner == nullptr)
+	{
+		Scheduler::acquireMutex(*this, task);
+		return true;
+	}
+
+	if (timeout_time.has_value() && timeout_time.value() <= Scheduler::now())
+		return false;
+
+	task.m_blockedOn = this; // the owner inherits its priority as soon as it is in the waiting list
+	if (timeout_time.has_value())
+		m_waiters.wait_until(m_guard, timeout_time.value());
+	else
+		m_waiters.wait(m_guard);
+
+	if (m_owner == &task) // handed over by unlock, which already updated everything
+		return true;
+
+	Scheduler::abandonMutex(*this, task); // timed out, the owner no longer inherits its priority (already done if the Systick ended the wait)
+	return false;
+}
+
+}
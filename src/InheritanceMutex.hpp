@@ -0,0 +1,130 @@
+/**
+ ******************************************************************************
+ * @file    InheritanceMutex.hpp
+ * @author  Thomas Legrand
+ * @version V0.1
+ * @date    16-October-2026
+ * @brief   Blocking mutex with priority inheritance
+ *
+ * 			This file contains the @c InheritanceMutex class, a mutual exclusion
+ * 			between @c Task that puts contending @c Task to sleep.
+ *
+ * 			Unlike a task only @c PriorityMutex, which is a critical section and
+ * 			stops all scheduling while it is held, an @c InheritanceMutex only
+ * 			blocks the @c Task that want it. Its owner inherits the @c Priority of
+ * 			the most important waiting @c Task (transitively, if the owner itself
+ * 			waits for another @c InheritanceMutex), so a less important @c Task
+ * 			holding it cannot delay a more important one for longer than the
+ * 			critical code it protects.
+ *
+ ******************************************************************************
+ * @copyright Copyright 2019 Thomas Legrand under the MIT License
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************
+ * @see https://github.com/Otatiaro/OpSy
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <optional>
+
+#include "Config.hpp"
+#include "ConditionVariable.hpp"
+
+namespace opsy
+{
+
+class TaskControlBlock;
+
+/**
+ * @brief A mutual exclusion between @c Task, with priority inheritance.
+ * A @c Task that cannot take it sleeps, in @c Priority order, until its owner releases it, other @c Task keep running meanwhile.
+ * It can be held for a long time, e.g. around slow flash or SPI transfers
+ * @remark It satisfies the @c Lockable and @c TimedLockable requirements, so it can be used with @c std::lock_guard and @c std::unique_lock
+ * @warning Only a @c Task can use it, never an interrupt service routine. It is not recursive, and a @c Task must release it before it ends
+ */
+class InheritanceMutex
+{
+	friend class Scheduler;
+
+public:
+
+	constexpr InheritanceMutex() = default;
+
+	InheritanceMutex(const InheritanceMutex&) = delete;
+	void operator=(const InheritanceMutex&) = delete;
+
+	/**
+	 * @brief Takes the @c InheritanceMutex, waiting as long as needed
+	 * @remark While the calling @c Task waits, the owner runs at least at its @c Priority
+	 */
+	void lock();
+
+	/**
+	 * @brief Takes the @c InheritanceMutex if it is free
+	 * @return @c true if it was taken, @c false otherwise
+	 */
+	bool try_lock();
+
+	/**
+	 * @brief Takes the @c InheritanceMutex, waiting at most @p timeout
+	 * @param timeout The time limit of the wait
+	 * @return @c true if it was taken, @c false if @p timeout elapsed first
+	 */
+	bool try_lock_for(duration timeout);
+
+	/**
+	 * @brief Takes the @c InheritanceMutex, waiting at most up to @p timeout_time
+	 * @param timeout_time The time limit of the wait
+	 * @return @c true if it was taken, @c false if @p timeout_time was reached first
+	 */
+	bool try_lock_until(time_point timeout_time);
+
+	/**
+	 * @brief Releases the @c InheritanceMutex
+	 * @remark It is handed over to the most important waiting @c Task, if any, and the calling @c Task gives back the @c Priority it inherited
+	 * @warning Only its owner can release it
+	 */
+	void unlock();
+
+	/**
+	 * @brief Gets the @c Task holding the @c InheritanceMutex
+	 * @return The owner, @c nullptr if it is free
+	 */
+	const TaskControlBlock* owner() const
+	{
+		return m_owner;
+	}
+
+private:
+
+	Mutex m_guard; // no other Task may release it between the check and the wait
+	ConditionVariable m_waiters;
+	TaskControlBlock* m_owner = nullptr;
+	InheritanceMutex* m_nextHeld = nullptr; // the list of InheritanceMutex held by the owner
+
+	bool acquire(std::optional<time_point> timeout_time);
+};
+
+}
@@ -0,0 +1,291 @@
+/**
+ ******************************************************************************
+ * @file    MemoryPool.hpp
+ * @author  Thomas Legrand
+ * @version V0.1
+ * @date    16-October-2026
+ * @brief   Fixed size block pools
+ *
+ * 			This file contains the @c MemoryPool class, a pool of fixed size blocks
+ * 			holding a given type, and the @c MemoryPoolResource class, that makes a
+ * 			@c MemoryPool a @c std::pmr::memory_resource.
+ *
+ * 			Allocating and freeing a block is constant time, and there is no
+ * 			fragmentation. The free blocks are kept in a list changed with exclusive
+ * 			load and store, so it takes no lock. A @c Semaphore counts the free
+ * 			blocks, a @c Task can then wait for one.
+ *
+ ******************************************************************************
+ * @copyright Copyright 2019 Thomas Legrand under the MIT License
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************
+ * @see https://github.com/Otatiaro/OpSy
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+
+#include "Config.hpp"
+#include "Semaphore.hpp"
+
+namespace opsy
+{
+
+/**
+ * @brief A pool of @p Count blocks, each one the storage of a @p T.
+ * A block is taken with @c allocate (or one of the @c try_allocate), and given back with @c deallocate, both in constant time.
+ * @tparam T The type the blocks are the storage of, it is not constructed: use placement new and call its destructor before @c deallocate
+ * @tparam Count The number of blocks
+ * @remark @c try_allocate and @c deallocate never wait, and the free list takes no lock, so interrupt service routines can call them too
+ * @warning Only interrupt service routines at or below @c kPriority can use it
+ */
+template<typename T, std::size_t Count>
+class MemoryPool
+{
+	static_assert(Count > 0 && Count < UINT32_MAX, "A MemoryPool needs at least one block, indexed by an uint32_t");
+
+	union Block
+	{
+		uint32_t next; // index of the next free block, while it is free
+		std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+	};
+
+public:
+
+	/**
+	 * @brief The most important @c IsrPriority allowed to use a @c MemoryPool, the one of its @c Semaphore
+	 */
+	static constexpr auto kPriority = Semaphore::kPriority;
+
+	/**
+	 * @brief The size of a block, at least the one of an @c uint32_t
+	 */
+	static constexpr std::size_t kBlockSize = sizeof(Block);
+
+	/**
+	 * @brief The alignment of a block, at least the one of an @c uint32_t
+	 */
+	static constexpr std::size_t kBlockAlignment = alignof(Block);
+
+	/**
+	 * @brief Creates a @c MemoryPool with all its blocks free
+	 */
+	MemoryPool()
+	{
+		for (uint32_t i = 0; i < Count; ++i)
+			m_blocks[i].next = i + 1;
+	}
+
+	MemoryPool(const MemoryPool&) = delete;
+	void operator=(const MemoryPool&) = delete;
+
+	/**
+	 * @brief Takes a block, waiting as long as needed for one
+	 * @return The block
+	 * @warning This should only be called from @c Task
+	 */
+	T* allocate()
+	{
+		m_available.acquire();
+		return take();
+	}
+
+	/**
+	 * @brief Takes a block if there is one
+	 * @return The block, or @c nullptr if there is no free block
+	 * @remark It never waits, so interrupt service routines can call it too
+	 */
+	T* try_allocate()
+	{
+		return m_available.try_acquire() ? take() : nullptr;
+	}
+
+	/**
+	 * @brief Takes a block, waiting at most @p timeout for one
+	 * @param timeout The time limit of the wait
+	 * @return The block, or @c nullptr if @p timeout elapsed first
+	 * @warning This should only be called from @c Task
+	 */
+	T* try_allocate_for(duration timeout)
+	{
+		return m_available.try_acquire_for(timeout) ? take() : nullptr;
+	}
+
+	/**
+	 * @brief Takes a block, waiting at most up to @p timeout_time for one
+	 * @param timeout_time The time limit of the wait
+	 * @return The block, or @c nullptr if @p timeout_time was reached first
+	 * @warning This should only be called from @c Task
+	 */
+	T* try_allocate_until(time_point timeout_time)
+	{
+		return m_available.try_acquire_until(timeout_time) ? take() : nullptr;
+	}
+
+	/**
+	 * @brief Gives back a block, handing it over to the most important waiting @c Task if any
+	 * @param block The block, it must come from this @c MemoryPool
+	 * @remark It can be called from a @c Task or an interrupt service routine
+	 */
+	void deallocate(T* block)
+	{
+		assert(contains(block));
+		give(*reinterpret_cast<Block*>(block));
+		m_available.release();
+	}
+
+	/**
+	 * @brief Checks if a pointer is a block of this @c MemoryPool
+	 * @param pointer The pointer to check
+	 * @return @c true if @p pointer is the start of one of the blocks, @c false otherwise
+	 */
+	bool contains(const void* pointer) const
+	{
+		const auto address = reinterpret_cast<uintptr_t>(pointer);
+		const auto first = reinterpret_cast<uintptr_t>(m_blocks.data());
+		return address >= first && address < first + sizeof(m_blocks) && (address - first) % sizeof(Block) == 0;
+	}
+
+	/**
+	 * @brief Gets the number of free blocks
+	 * @return The number of free blocks, @c 0 if a @c Task waits
+	 */
+	std::size_t available() const
+	{
+		return m_available.count();
+	}
+
+	/**
+	 * @brief Gets the number of blocks
+	 * @return The number of blocks
+	 */
+	static constexpr std::size_t capacity()
+	{
+		return Count;
+	}
+
+private:
+
+	std::array<Block, Count> m_blocks;
+	uint32_t m_free = 0; // index of the first free block, Count if none, only changed by exclusive load and store
+	Semaphore m_available { Count, Count }; // the free blocks not reserved yet, the list has at least as many
+
+	/**
+	 * @brief Removes the first block of the free list, the @c Semaphore reserved it
+	 */
+	T* take()
+	{
+		while (true)
+		{
+			const auto index = CortexM::loadExclusive(&m_free);
+			assert(index < Count);
+			const auto next = m_blocks[index].next; // if the block was taken and given back in between, the store fails
+			if (CortexM::storeExclusive(&m_free, next) == 0)
+				return reinterpret_cast<T*>(&m_blocks[index].storage);
+		}
+	}
+
+	/**
+	 * @brief Adds a block at the front of the free list
+	 */
+	void give(Block& block)
+	{
+		const auto index = static_cast<uint32_t>(&block - m_blocks.data());
+		auto first = m_free;
+
+		while (true)
+		{
+			block.next = first; // set outside of the exclusive access, a store in between may clear the monitor
+			const auto current = CortexM::loadExclusive(&m_free);
+			if (current == first && CortexM::storeExclusive(&m_free, index) == 0)
+				return;
+			first = current;
+		}
+	}
+};
+
+#if __has_include(<memory_resource>)
+
+/**
+ * @brief A @c std::pmr::memory_resource giving the blocks of a @c MemoryPool, e.g. to the nodes of a @c std::pmr::list
+ * @tparam T The type of the @c MemoryPool blocks
+ * @tparam Count The number of blocks of the @c MemoryPool
+ * @remark Requests larger or more aligned than a block, or made while no block is free, go to the upstream resource, which by default fails as an exhausted pool would
+ * @warning It never waits for a block, but the upstream resource may
+ */
+template<typename T, std::size_t Count>
+class MemoryPoolResource: public std::pmr::memory_resource
+{
+public:
+
+	/**
+	 * @brief Creates a @c MemoryPoolResource
+	 * @param pool The @c MemoryPool giving the blocks
+	 * @param upstream The resource used for the requests the pool cannot serve
+	 */
+	explicit MemoryPoolResource(MemoryPool<T, Count>& pool, std::pmr::memory_resource* upstream = std::pmr::null_memory_resource()) :
+			m_pool(pool), m_upstream(upstream)
+	{
+	}
+
+private:
+
+	MemoryPool<T, Count>& m_pool;
+	std::pmr::memory_resource* const m_upstream;
+
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override
+	{
+		if (bytes <= MemoryPool<T, Count>::kBlockSize && alignment <= MemoryPool<T, Count>::kBlockAlignment)
+			if (auto block = m_pool.try_allocate())
+				return block;
+		return m_upstream->allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override
+	{
+		if (m_pool.contains(pointer))
+			m_pool.deallocate(static_cast<T*>(pointer));
+		else
+			m_upstream->deallocate(pointer, bytes, alignment);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+	{
+		return this == &other;
+	}
+};
+
+#endif
+
+}
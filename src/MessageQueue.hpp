@@ -0,0 +1,291 @@
+/**
+ ******************************************************************************
+ * @file    MessageQueue.hpp
+ * @author  Thomas Legrand
+ * @version V0.1
+ * @date    16-October-2026
+ * @brief   Bounded queue of messages between tasks
+ *
+ * 			This file contains the @c MessageQueue class template, a bounded queue
+ * 			of typed messages between @c Task, with blocking send and receive, and
+ * 			a non-blocking send for interrupt service routines.
+ *
+ * 			The storage is a fixed array, nothing is allocated. A message sent to
+ * 			a waiting receiver is handed over directly, without going through the
+ * 			array, and a waiting sender is taken a message as soon as there is
+ * 			room. Waiting @c Task are served in @c Priority order.
+ *
+ ******************************************************************************
+ * @copyright Copyright 2019 Thomas Legrand under the MIT License
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************
+ * @see https://github.com/Otatiaro/OpSy
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "Config.hpp"
+#include "ConditionVariable.hpp"
+#include "Scheduler.hpp"
+
+namespace opsy
+{
+
+/**
+ * @brief A bounded queue of messages.
+ * @c send waits for room when it is full, @c receive waits for a message when it is empty, both with an optional time limit
+ * @tparam T The type of the messages, which must be default constructible and move assignable
+ * @tparam Capacity The number of messages it holds
+ * @remark Messages are copied (or moved) once: a sender hands its message over to the most important waiting receiver, a receiver takes the message of the most important waiting sender into the room it frees
+ * @remark The hand over is done with the @c Scheduler locked, keep messages small (a few words) and pass pointers to larger data
+ * @warning Interrupt service routines may only use @c try_send and @c try_receive, at or below @c kPriority
+ */
+template<typename T, std::size_t Capacity>
+class MessageQueue
+{
+	static_assert(Capacity > 0, "MessageQueue capacity cannot be 0");
+
+	template<std::size_t Size>
+	friend class WaitSet;
+
+public:
+
+	/**
+	 * @brief The most important @c IsrPriority allowed to use a @c MessageQueue, the one of the @c Mutex protecting it, just below the @c Scheduler
+	 */
+	static constexpr auto kPriority = IsrPriority::FromPreemptSub<kPreemptionBits>(kOpsyPreemption + 1, 0);
+
+	constexpr MessageQueue() = default;
+
+	MessageQueue(const MessageQueue&) = delete;
+	void operator=(const MessageQueue&) = delete;
+
+	/**
+	 * @brief Gets the number of messages it holds
+	 * @return The capacity
+	 */
+	static constexpr std::size_t capacity()
+	{
+		return Capacity;
+	}
+
+	/**
+	 * @brief Gets the number of messages waiting to be received
+	 * @return The number of messages, the ones of waiting senders are not counted
+	 */
+	std::size_t size() const
+	{
+		return m_size;
+	}
+
+	/**
+	 * @brief Sends a message, waiting as long as needed for room
+	 * @param message The message to send
+	 * @warning This should only be called from @c Task
+	 */
+	void send(T message)
+	{
+		[[maybe_unused]] const bool sent = put(message, std::nullopt);
+		assert(sent); // without time limit, the wait only ends when a receiver takes the message
+	}
+
+	/**
+	 * @brief Sends a message if there is room
+	 * @param message The message to send
+	 * @return @c true if it was sent, @c false if the queue is full
+	 * @remark It never waits, so interrupt service routines can call it too
+	 */
+	bool try_send(T message)
+	{
+		return put(message, Startup); // already elapsed, do not wait
+	}
+
+	/**
+	 * @brief Sends a message, waiting at most @p timeout for room
+	 * @param message The message to send
+	 * @param timeout The time limit of the wait
+	 * @return @c true if it was sent, @c false if @p timeout elapsed first
+	 * @warning This should only be called from @c Task
+	 */
+	bool try_send_for(T message, duration timeout)
+	{
+		return put(message, Scheduler::now() + timeout);
+	}
+
+	/**
+	 * @brief Sends a message, waiting at most up to @p timeout_time for room
+	 * @param message The message to send
+	 * @param timeout_time The time limit of the wait
+	 * @return @c true if it was sent, @c false if @p timeout_time was reached first
+	 * @warning This should only be called from @c Task
+	 */
+	bool try_send_until(T message, time_point timeout_time)
+	{
+		return put(message, timeout_time);
+	}
+
+	/**
+	 * @brief Receives the oldest message, waiting as long as needed for one
+	 * @param message Receives the message
+	 * @warning This should only be called from @c Task
+	 */
+	void receive(T& message)
+	{
+		[[maybe_unused]] const bool received = get(message, std::nullopt);
+		assert(received); // without time limit, the wait only ends when a sender hands a message over
+	}
+
+	/**
+	 * @brief Receives the oldest message if there is one
+	 * @param message Receives the message
+	 * @return @c true if a message was received, @c false if the queue is empty
+	 * @remark It never waits, so interrupt service routines can call it too
+	 */
+	bool try_receive(T& message)
+	{
+		return get(message, Startup); // already elapsed, do not wait
+	}
+
+	/**
+	 * @brief Receives the oldest message, waiting at most @p timeout for one
+	 * @param message Receives the message
+	 * @param timeout The time limit of the wait
+	 * @return @c true if a message was received, @c false if @p timeout elapsed first
+	 * @warning This should only be called from @c Task
+	 */
+	bool try_receive_for(T& message, duration timeout)
+	{
+		return get(message, Scheduler::now() + timeout);
+	}
+
+	/**
+	 * @brief Receives the oldest message, waiting at most up to @p timeout_time for one
+	 * @param message Receives the message
+	 * @param timeout_time The time limit of the wait
+	 * @return @c true if a message was received, @c false if @p timeout_time was reached first
+	 * @warning This should only be called from @c Task
+	 */
+	bool try_receive_until(T& message, time_point timeout_time)
+	{
+		return get(message, timeout_time);
+	}
+
+private:
+
+	Mutex m_guard { kPriority }; // nothing may change the queue between the check and the wait
+	ConditionVariable m_senders; // wait for room, the queue is full
+	ConditionVariable m_receivers; // wait for a message, the queue is empty
+	std::array<T, Capacity> m_messages { };
+	std::size_t m_first = 0;
+	std::size_t m_size = 0;
+
+	bool put(T& message, std::optional<time_point> timeout_time)
+	{
+		std::unique_lock<Mutex> guard(m_guard);
+
+		if (give(message))
+			return true;
+
+		return wait(m_senders, &message, timeout_time); // a receiver takes it when it frees room
+	}
+
+	bool get(T& message, std::optional<time_point> timeout_time)
+	{
+		std::unique_lock<Mutex> guard(m_guard);
+
+		if (take(message))
+			return true;
+
+		return wait(m_receivers, &message, timeout_time); // a sender hands its message over
+	}
+
+	/**
+	 * @brief Hands @p message over to the most important waiting receiver, or adds it to the queue, with @c m_guard locked (or anything that locks it masked)
+	 * @return @c false if the queue is full
+	 */
+	bool give(T& message)
+	{
+		if (Scheduler::wakeUpFirst(m_receivers, [&message](WaitNode& node) { *static_cast<T*>(node.m_message) = std::move(message); })) // a receiver waits, the queue is empty
+			return true;
+
+		if (m_size == Capacity)
+			return false;
+
+		m_messages[(m_first + m_size) % Capacity] = std::move(message);
+		++m_size;
+		return true;
+	}
+
+	/**
+	 * @brief Takes the oldest message, then the message of the most important waiting sender takes the room freed, with @c m_guard locked (or anything that locks it masked)
+	 * @return @c false if the queue is empty
+	 */
+	bool take(T& message)
+	{
+		if (m_size == 0)
+			return false;
+
+		message = std::move(m_messages[m_first]);
+		m_first = (m_first + 1) % Capacity;
+		--m_size;
+
+		Scheduler::wakeUpFirst(m_senders, [this](WaitNode& node) // a sender waits for room, its message goes last
+			{
+				m_messages[(m_first + m_size) % Capacity] = std::move(*static_cast<T*>(node.m_message));
+				++m_size;
+			});
+		return true;
+	}
+
+	/**
+	 * @brief Waits, with @c m_guard locked, for a @c Task to take or give @p message
+	 */
+	bool wait(ConditionVariable& waiters, T* message, std::optional<time_point> timeout_time)
+	{
+		if (timeout_time.has_value() && timeout_time.value() <= Scheduler::now())
+			return false;
+
+		assert(CortexM::ipsr() == 0); // cannot wait in interrupt
+		auto& node = Scheduler::s_currentTask->m_waitNode;
+		node.m_message = message;
+
+		bool handed = true;
+		if (timeout_time.has_value())
+			handed = waiters.wait_until(m_guard, timeout_time.value()) == std::cv_status::no_timeout;
+		else
+			waiters.wait(m_guard);
+
+		node.m_message = nullptr;
+		return handed;
+	}
+};
+
+}
@@ -0,0 +1,58 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+#include "opsy.hpp"
+
+namespace opsy
+{
+
+void Periodic::start()
+{
+	assert(CortexM::ipsr() == 0); // cannot call in interrupt
+	m_task = Scheduler::s_currentTask;
+	m_release = Scheduler::now();
+	m_jitter = m_maxJitter = m_overruns = m_misses = 0;
+}
+
+bool Periodic::wait()
+{
+	assert(m_task == Scheduler::s_currentTask); // started, and by this task
+	const auto end = Scheduler::now();
+
+	if (end > m_release + m_deadline)
+	{
+		++m_misses;
+		OptionalHooks::deadlineMissed(*m_task);
+	}
+
+	m_release += m_period;
+	if (end >= m_release) // the release tick has come already
+	{
+		++m_overruns;
+		OptionalHooks::periodOverrun(*m_task);
+		m_jitter = 0;
+		sleep_until(m_release); // returns right away, but starts a new activation for the scheduler
+		return false;
+	}
+
+	sleep_until(m_release);
+	m_jitter = sinceRelease();
+	m_maxJitter = std::max(m_maxJitter, m_jitter);
+	return true;
+}
+
+uint32_t Periodic::sinceRelease() const
+{
+	while (true)
+	{
+		const auto ticks = Scheduler::now();
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+		const auto count = CortexM::systickCount();
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+		if (Scheduler::now() == ticks) // no tick in between, the counter value belongs to this tick
+			return static_cast<uint32_t>((ticks - m_release).count()) * Scheduler::s_tickCycles + count;
+	}
+}
+
+}
@@ -0,0 +1,179 @@
+/**
+ ******************************************************************************
+ * @file    Periodic.hpp
+ * @author  Thomas Legrand
+ * @version V0.1
+ * @date    16-October-2026
+ * @brief   Periodic release of a Task
+ *
+ * 			This file contains the @c Periodic class, which releases a @c Task
+ * 			at a fixed period.
+ *
+ * 			The releases are absolute @c time_point on a grid set when it starts,
+ * 			given as is to the @c Scheduler (@c sleep_until), so they do not drift
+ * 			whatever the time the @c Task takes or the preemptions it suffers.
+ * 			The release jitter (from the release tick to the @c Task running) is
+ * 			measured in core cycles, and overruns and missed deadlines are reported
+ * 			through @c Hooks.
+ *
+ ******************************************************************************
+ * @copyright Copyright 2019 Thomas Legrand under the MIT License
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************
+ * @see https://github.com/Otatiaro/OpSy
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "Config.hpp"
+#include "Task.hpp"
+
+namespace opsy
+{
+
+/**
+ * @brief Releases the @c Task that uses it at a fixed period
+ * @remark A typical control loop:
+ * @code
+ * Periodic loop(1ms);
+ * loop.start();
+ * while (true)
+ * {
+ * 	control();
+ * 	loop.wait();
+ * }
+ * @endcode
+ * @warning It must only be used by one @c Task, the one that starts it
+ */
+class Periodic
+{
+public:
+
+	/**
+	 * @brief Creates a @c Periodic
+	 * @param period The period of the releases
+	 * @param deadline The deadline of each activation, relative to its release, @c duration(0) for the end of the period
+	 */
+	constexpr explicit Periodic(duration period, duration deadline = duration(0)) :
+			m_period(period), m_deadline(deadline.count() != 0 ? deadline : period)
+	{
+	}
+
+	Periodic(const Periodic&) = delete;
+	void operator=(const Periodic&) = delete;
+
+	/**
+	 * @brief Starts the first activation now, the following releases are @c period apart from now
+	 * @warning It must be called by the @c Task that uses the @c Periodic
+	 */
+	void start();
+
+	/**
+	 * @brief Ends the current activation and sleeps up to the next release
+	 * @return @c true if the next release was still to come, @c false if the activation overran its period (it returns right away, the following releases stay on the grid)
+	 * @remark @c Hooks::deadlineMissed is called when the activation ends after its deadline, @c Hooks::periodOverrun when it ends after the next release
+	 */
+	bool wait();
+
+	/**
+	 * @brief Gets the release of the current activation
+	 * @return The release of the current activation
+	 */
+	constexpr time_point release() const
+	{
+		return m_release;
+	}
+
+	/**
+	 * @brief Gets the period of the releases
+	 * @return The period of the releases
+	 */
+	constexpr duration period() const
+	{
+		return m_period;
+	}
+
+	/**
+	 * @brief Gets the deadline of the activations, relative to their release
+	 * @return The deadline of the activations
+	 */
+	constexpr duration deadline() const
+	{
+		return m_deadline;
+	}
+
+	/**
+	 * @brief Gets the release jitter of the current activation
+	 * @return The core cycles from the release tick to the @c Task running again in @c wait
+	 * @remark It includes the Systick handler, the context switch and the preemptions by more important @c Task, @c 0 for an overrun activation (not measured)
+	 */
+	constexpr uint32_t jitter() const
+	{
+		return m_jitter;
+	}
+
+	/**
+	 * @brief Gets the largest release jitter since the @c Periodic started
+	 * @return The largest release jitter, in core cycles
+	 */
+	constexpr uint32_t maxJitter() const
+	{
+		return m_maxJitter;
+	}
+
+	/**
+	 * @brief Gets the number of activations that ended after the next release since the @c Periodic started
+	 * @return The number of overruns
+	 */
+	constexpr uint32_t overruns() const
+	{
+		return m_overruns;
+	}
+
+	/**
+	 * @brief Gets the number of activations that ended after their deadline since the @c Periodic started
+	 * @return The number of missed deadlines
+	 */
+	constexpr uint32_t misses() const
+	{
+		return m_misses;
+	}
+
+private:
+
+	const duration m_period;
+	const duration m_deadline;
+	TaskControlBlock* m_task = nullptr;
+	time_point m_release = Startup;
+	uint32_t m_jitter = 0;
+	uint32_t m_maxJitter = 0;
+	uint32_t m_overruns = 0;
+	uint32_t m_misses = 0;
+
+	uint32_t sinceRelease() const;
+};
+
+}
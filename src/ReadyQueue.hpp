@@ -0,0 +1,304 @@
+/**
+ ******************************************************************************
+ * @file    ReadyQueue.hpp
+ * @author  Thomas Legrand
+ * @version V0.1
+ * @date    16-October-2026
+ * @brief   Containers for the @c Scheduler ready @c Task
+ *
+ * 			The containers used by the @c Scheduler to hold ready @c Task.
+ *
+ * 			@c SortedReadyQueue keeps a single list sorted with
+ * 			@c TaskControlBlock::priorityIsLower, it is small but each insertion
+ * 			walks the list.
+ *
+ * 			@c BitmapReadyQueue keeps one FIFO per @c Priority level and a two
+ * 			level bitmap of the non empty levels. The most important level is
+ * 			found with two @c CLZ instructions, so insertion, removal and
+ * 			selection of the next @c Task are constant time whatever the number
+ * 			of ready @c Task.
+ *
+ * 			With @c kEdfScheduling, the @c Task of a @c Priority level are kept
+ * 			by order of their deadline, in both containers. The bitmap one then
+ * 			walks the level on insertion, its cost grows with the number of
+ * 			ready @c Task sharing that @c Priority.
+ *
+ * 			The implementation used is selected with @c kBitmapReadyQueue
+ *
+ ******************************************************************************
+ * @copyright Copyright 2019 Thomas Legrand under the MIT License
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************
+ * @see https://github.com/Otatiaro/OpSy
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cassert>
+#include <type_traits>
+
+#include "Config.hpp"
+#include "EmbeddedList.hpp"
+#include "Task.hpp"
+#include "CortexM.hpp"
+
+namespace opsy
+{
+
+/**
+ * @brief A ready queue that keeps all ready @c Task in a single list sorted by @c Priority
+ */
+class SortedReadyQueue
+{
+public:
+
+	/**
+	 * @brief Checks if there is no ready @c Task
+	 * @return @c true if there is no ready @c Task, @c false otherwise
+	 */
+	inline bool empty() const
+	{
+		return m_list.empty();
+	}
+
+	/**
+	 * @brief Gets the most important ready @c Task
+	 * @return The most important ready @c Task
+	 */
+	inline TaskControlBlock& front()
+	{
+		return m_list.front();
+	}
+
+	/**
+	 * @brief Removes the most important ready @c Task
+	 */
+	inline void pop_front()
+	{
+		m_list.pop_front();
+	}
+
+	/**
+	 * @brief Inserts a @c Task in the ready queue
+	 * @param task The @c Task to insert
+	 */
+	inline void insert(TaskControlBlock& task)
+	{
+		m_list.insertWhen(TaskControlBlock::priorityIsLower, task);
+	}
+
+	/**
+	 * @brief Puts back a @c Task that was just taken from the front of the ready queue
+	 * @param task The @c Task to put back
+	 * @remark It goes before the other ready @c Task of its @c Priority, @c m_lastStarted has a tick resolution so it cannot tell them apart when they all ran during the same tick
+	 */
+	inline void insertFront(TaskControlBlock& task)
+	{
+		m_list.insertWhen(isNotLessImportant, task);
+	}
+
+	/**
+	 * @brief Inserts a @c Task behind all the other ready @c Task of its @c Priority
+	 * @param task The @c Task to insert
+	 */
+	inline void insertBack(TaskControlBlock& task)
+	{
+		m_list.insertWhen(isMoreImportant, task);
+	}
+
+	/**
+	 * @brief Removes a @c Task from the ready queue
+	 * @param task The @c Task to remove
+	 */
+	inline void erase(TaskControlBlock& task)
+	{
+		m_list.erase(task);
+	}
+
+private:
+
+	static constexpr bool isNotLessImportant(const TaskControlBlock& left, const TaskControlBlock& right)
+	{
+		if constexpr (kEdfScheduling)
+			if (left.priority() == right.priority())
+				return left.deadline() <= right.deadline();
+		return left.priority() <= right.priority();
+	}
+
+	static constexpr bool isMoreImportant(const TaskControlBlock& left, const TaskControlBlock& right)
+	{
+		if constexpr (kEdfScheduling)
+			if (left.priority() == right.priority())
+				return left.deadline() < right.deadline();
+		return left.priority() < right.priority();
+	}
+
+	EmbeddedList<TaskControlBlock, TaskLists::Ready> m_list;
+};
+
+/**
+ * @brief A ready queue with one FIFO per @c Priority level and a bitmap of non empty levels
+ * @remark All operations are constant time, @c Task of the same @c Priority are served in FIFO order (by deadline with @c kEdfScheduling, insertion then walks the level)
+ * @warning The @c Priority (and deadline) of a @c Task must not change while it is in the queue, remove it first
+ */
+class BitmapReadyQueue
+{
+public:
+
+	/**
+	 * @brief Checks if there is no ready @c Task
+	 * @return @c true if there is no ready @c Task, @c false otherwise
+	 */
+	inline bool empty() const
+	{
+		return m_groups == 0;
+	}
+
+	/**
+	 * @brief Gets the most important ready @c Task
+	 * @return The most important ready @c Task
+	 */
+	inline TaskControlBlock& front()
+	{
+		return m_levels[highest()].front();
+	}
+
+	/**
+	 * @brief Removes the most important ready @c Task
+	 */
+	inline void pop_front()
+	{
+		const auto level = highest();
+		m_levels[level].pop_front();
+		if (m_levels[level].empty())
+			unmark(level);
+	}
+
+	/**
+	 * @brief Inserts a @c Task at the end of its @c Priority level (with @c kEdfScheduling, behind the @c Task of its level whose deadline is not later)
+	 * @param task The @c Task to insert
+	 */
+	inline void insert(TaskControlBlock& task)
+	{
+		const auto level = levelOf(task);
+		if constexpr (kEdfScheduling)
+			m_levels[level].insertWhen(isEarlier, task);
+		else
+			m_levels[level].push_back(task);
+		mark(level);
+	}
+
+	/**
+	 * @brief Puts back a @c Task that was just taken from the front of the ready queue, at the beginning of its @c Priority level (with @c kEdfScheduling, before the @c Task of its level whose deadline is not earlier)
+	 * @param task The @c Task to put back
+	 */
+	inline void insertFront(TaskControlBlock& task)
+	{
+		const auto level = levelOf(task);
+		if constexpr (kEdfScheduling)
+			m_levels[level].insertWhen(isNotLater, task);
+		else
+			m_levels[level].push_front(task);
+		mark(level);
+	}
+
+	/**
+	 * @brief Inserts a @c Task at the end of its @c Priority level, behind all the other ready @c Task of its @c Priority
+	 * @param task The @c Task to insert
+	 */
+	inline void insertBack(TaskControlBlock& task)
+	{
+		insert(task);
+	}
+
+	/**
+	 * @brief Removes a @c Task from the ready queue
+	 * @param task The @c Task to remove
+	 */
+	inline void erase(TaskControlBlock& task)
+	{
+		const auto level = levelOf(task);
+		m_levels[level].erase(task);
+		if (m_levels[level].empty())
+			unmark(level);
+	}
+
+private:
+
+	static constexpr std::size_t kLevels = 256; // one level per Priority value
+	static constexpr std::size_t kWordBits = 32;
+	static constexpr std::size_t kWordShift = 5;
+	static constexpr std::size_t kWords = kLevels / kWordBits;
+	static constexpr uint32_t kFirstBit = 0x80000000u; // level 0 (most important) is the most significant bit, so CLZ gives the most important level
+
+	static_assert(kWords <= kWordBits, "Summary word too small for the number of levels");
+
+	uint32_t m_groups = 0; // bit set when the matching word of m_words is not zero
+	std::array<uint32_t, kWords> m_words { };
+	std::array<EmbeddedList<TaskControlBlock, TaskLists::Ready>, kLevels> m_levels;
+
+	static constexpr inline uint8_t levelOf(const TaskControlBlock& task)
+	{
+		return static_cast<uint8_t>(task.priority());
+	}
+
+	static constexpr bool isEarlier(const TaskControlBlock& left, const TaskControlBlock& right)
+	{
+		return left.deadline() < right.deadline();
+	}
+
+	static constexpr bool isNotLater(const TaskControlBlock& left, const TaskControlBlock& right)
+	{
+		return left.deadline() <= right.deadline();
+	}
+
+	inline uint8_t highest() const
+	{
+		assert(!empty());
+		const auto word = CortexM::countLeadingZeros(m_groups);
+		return static_cast<uint8_t>((word << kWordShift) + CortexM::countLeadingZeros(m_words[word]));
+	}
+
+	inline void mark(uint8_t level)
+	{
+		m_words[level >> kWordShift] |= kFirstBit >> (level & (kWordBits - 1));
+		m_groups |= kFirstBit >> (level >> kWordShift);
+	}
+
+	inline void unmark(uint8_t level)
+	{
+		m_words[level >> kWordShift] &= ~(kFirstBit >> (level & (kWordBits - 1)));
+		if (m_words[level >> kWordShift] == 0)
+			m_groups &= ~(kFirstBit >> (level >> kWordShift));
+	}
+};
+
+/**
+ * @brief The ready queue implementation used by the @c Scheduler, selected with @c kBitmapReadyQueue
+ */
+using ReadyQueue = std::conditional_t<kBitmapReadyQueue, BitmapReadyQueue, SortedReadyQueue>;
+
+}
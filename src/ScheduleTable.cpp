@@ -0,0 +1,25 @@
+#include <cassert>
+
+#include "ScheduleTable.hpp"
+#include "Scheduler.hpp"
+
+namespace opsy
+{
+
+void ScheduleTable::start() const
+{
+	assert(isValid());
+	Scheduler::startTable(this);
+}
+
+void ScheduleTable::stop()
+{
+	Scheduler::startTable(nullptr);
+}
+
+void ScheduleTable::wait()
+{
+	Scheduler::serviceCall<Scheduler::ServiceCallNumber::WaitDispatch>();
+}
+
+}
@@ -0,0 +1,178 @@
+/**
+ ******************************************************************************
+ * @file    ScheduleTable.hpp
+ * @author  Thomas Legrand
+ * @version V0.1
+ * @date    16-October-2026
+ * @brief   Time-triggered schedule table
+ *
+ * 			This file contains the @c ScheduleTable class, a time-triggered
+ * 			executive that runs alongside the priority based @c Scheduler.
+ *
+ * 			A constant table of entries, each one an offset in a major frame, a
+ * 			@c Task and a budget, is walked by the Systick: at its offset, the
+ * 			@c Task of an entry is switched to directly, without going through the
+ * 			ready queue, and keeps the processor until its job ends
+ * 			(@c ScheduleTable::wait). Other @c Task run in the time left.
+ *
+ * 			Job execution time is measured with the DWT cycle counter, overruns
+ * 			and dispatches that cannot happen are reported through @c Hooks.
+ *
+ ******************************************************************************
+ * @copyright Copyright 2019 Thomas Legrand under the MIT License
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************
+ * @see https://github.com/Otatiaro/OpSy
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+#include "Config.hpp"
+#include "Task.hpp"
+
+namespace opsy
+{
+
+/**
+ * @brief An entry of a @c ScheduleTable
+ */
+struct ScheduleEntry
+{
+	duration offset; ///< When the @c Task is dispatched, from the start of the major frame
+	TaskControlBlock* task; ///< The @c Task dispatched
+	std::chrono::microseconds budget; ///< The processor time its job may use, an overrun is reported through @c Hooks::scheduleOverrun
+};
+
+/**
+ * @brief A time-triggered schedule, dispatched by the @c Scheduler on each tick
+ * @remark A typical table and time-triggered @c Task:
+ * @code
+ * constexpr ScheduleEntry kEntries[] = { { 0ms, &sensors, 200us }, { 1ms, &control, 500us }, { 5ms, &sensors, 200us } };
+ * constexpr ScheduleTable kTable(10ms, kEntries);
+ * static_assert(kTable.isValid());
+ *
+ * control.start([]()
+ * 	{
+ * 		// initialization, runs as any other Task at its Priority
+ * 		while (true)
+ * 		{
+ * 			ScheduleTable::wait(); // ends the previous job, waits for the next dispatch
+ * 			step();
+ * 		}
+ * 	});
+ * kTable.start();
+ * @endcode
+ * @remark A dispatched @c Task runs until it calls @c wait, only interrupt service routines preempt it. Its @c Priority only matters before its first @c wait
+ * @remark The dispatch happens in the Systick, so the table offsets have the tick resolution but no release jitter (a @c Task in a critical section delays it to the end of the critical section)
+ * @warning A dispatched @c Task must not block (sleep or wait for a @c ConditionVariable or an @c InheritanceMutex) nor hold a @c CeilingMutex, and it should have no execution budget (@c TaskControlBlock::budget)
+ */
+class ScheduleTable
+{
+public:
+
+	/**
+	 * @brief Creates a @c ScheduleTable
+	 * @tparam N The number of entries
+	 * @param majorFrame The length of the major frame, the table is walked again every @p majorFrame
+	 * @param entries The entries, sorted by offset, all less than @p majorFrame
+	 */
+	template<std::size_t N>
+	constexpr ScheduleTable(duration majorFrame, const ScheduleEntry (&entries)[N]) :
+			m_majorFrame(majorFrame), m_entries(entries), m_size(N)
+	{
+	}
+
+	/**
+	 * @brief Checks the entries, to be used in a @c static_assert
+	 * @return @c true if the offsets are increasing and within the major frame, and each entry has a @c Task, @c false otherwise
+	 */
+	constexpr bool isValid() const
+	{
+		for (std::size_t i = 0; i < m_size; ++i)
+		{
+			if (m_entries[i].task == nullptr || m_entries[i].offset.count() < 0 || m_entries[i].offset >= m_majorFrame)
+				return false;
+			if (i > 0 && m_entries[i].offset <= m_entries[i - 1].offset)
+				return false;
+		}
+		return m_size > 0;
+	}
+
+	/**
+	 * @brief Gets the length of the major frame
+	 * @return The length of the major frame
+	 */
+	constexpr duration majorFrame() const
+	{
+		return m_majorFrame;
+	}
+
+	/**
+	 * @brief Gets the number of entries
+	 * @return The number of entries
+	 */
+	constexpr std::size_t size() const
+	{
+		return m_size;
+	}
+
+	/**
+	 * @brief Gets an entry
+	 * @param index The index of the entry
+	 * @return The entry
+	 */
+	constexpr const ScheduleEntry& operator[](std::size_t index) const
+	{
+		return m_entries[index];
+	}
+
+	/**
+	 * @brief Starts dispatching the table, the first major frame starts on the next tick
+	 * @remark It replaces the table being dispatched, if any, the job that runs goes on until it calls @c wait
+	 * @warning The @c Scheduler must be started
+	 */
+	void start() const;
+
+	/**
+	 * @brief Stops dispatching the table, the job that runs goes on until it calls @c wait
+	 */
+	static void stop();
+
+	/**
+	 * @brief Ends the job of the calling @c Task, which then waits for the next entry of the table dispatching it
+	 * @warning This should only be called from @c Task and never from interrupt service routine
+	 */
+	static void wait();
+
+private:
+
+	const duration m_majorFrame;
+	const ScheduleEntry* const m_entries;
+	const std::size_t m_size;
+};
+
+}
@@ -1,13 +1,18 @@
+#include <algorithm>
+
 #include "Scheduler.hpp"
+#include "InheritanceMutex.hpp"
 
 namespace opsy
 {
 
 __attribute__((section(".bss.opsy.scheduler.isstarted"))) bool Scheduler::s_isStarted = false;
 __attribute__((section(".bss.opsy.scheduler.ticks"))) opsy::time_point Scheduler::s_ticks = opsy::Startup;
+__attribute__((section(".bss.opsy.scheduler.tickcycles"))) uint32_t Scheduler::s_tickCycles = 0;
+__attribute__((section(".data.opsy.scheduler.stretchedticks"))) volatile uint32_t Scheduler::s_stretchedTicks = 1;
 __attribute__((section(".bss.opsy.scheduler.alltasks"))) EmbeddedList<TaskControlBlock, TaskLists::Handle> Scheduler::s_allTasks;
-__attribute__((section(".bss.opsy.scheduler.timeouts"))) EmbeddedList<TaskControlBlock, TaskLists::Timeout> Scheduler::s_timeouts;
-__attribute__((section(".bss.opsy.scheduler.ready"))) EmbeddedList<TaskControlBlock, TaskLists::Waiting> Scheduler::s_ready;
+__attribute__((section(".bss.opsy.scheduler.timeouts"))) TimeoutQueue<TaskControlBlock, TaskLists::Timeout> Scheduler::s_timeouts;
+__attribute__((section(".bss.opsy.scheduler.ready"))) ReadyQueue Scheduler::s_ready;
 __attribute__((section(".bss.opsy.scheduler.idling"))) bool Scheduler::s_idling = false;
 __attribute__((section(".bss.opsy.scheduler.mayneedswitch"))) bool Scheduler::s_mayNeedSwitch = false;
 __attribute__((section(".bss.opsy.scheduler.idle"))) IdleTaskControlBlock* Scheduler::s_idle;
@@ -15,6 +20,19 @@ __attribute__((section(".bss.opsy.scheduler.previoustask"))) TaskControlBlock* S
 __attribute__((section(".bss.opsy.scheduler.currenttask"))) TaskControlBlock* Scheduler::s_currentTask = nullptr;
 __attribute__((section(".bss.opsy.scheduler.nexttask"))) TaskControlBlock* Scheduler::s_nextTask = nullptr;
 __attribute__((section(".bss.opsy.scheduler.criticalsection"))) volatile bool Scheduler::s_criticalSection = false;
+__attribute__((section(".bss.opsy.scheduler.kernelaccounts"))) CpuAccount Scheduler::s_kernelAccounts[3];
+__attribute__((section(".bss.opsy.scheduler.account"))) CpuAccount* Scheduler::s_account = nullptr;
+__attribute__((section(".bss.opsy.scheduler.accountmark"))) uint32_t Scheduler::s_accountMark = 0;
+__attribute__((section(".bss.opsy.scheduler.windowstart"))) time_point Scheduler::s_windowStart = Startup;
+__attribute__((section(".bss.opsy.scheduler.previouswindow"))) duration Scheduler::s_previousWindow = duration(0);
+__attribute__((section(".bss.opsy.scheduler.mainwatermark"))) StackWatermark Scheduler::s_mainWatermark;
+__attribute__((section(".bss.opsy.scheduler.table"))) const ScheduleTable* Scheduler::s_table = nullptr;
+__attribute__((section(".bss.opsy.scheduler.tableindex"))) std::size_t Scheduler::s_tableIndex = 0;
+__attribute__((section(".bss.opsy.scheduler.framestart"))) time_point Scheduler::s_frameStart = Startup;
+__attribute__((section(".bss.opsy.scheduler.dispatched"))) TaskControlBlock* Scheduler::s_dispatched = nullptr;
+__attribute__((section(".bss.opsy.scheduler.dispatchstart"))) uint32_t Scheduler::s_dispatchStart = 0;
+__attribute__((section(".bss.opsy.scheduler.dispatchbudget"))) uint32_t Scheduler::s_dispatchBudget = 0;
+__attribute__((section(".bss.opsy.scheduler.dispatchoverrun"))) bool Scheduler::s_dispatchOverrun = false;
 
 bool __attribute__((section(".text.opsy.start"))) Scheduler::start(IdleTaskControlBlock& idle)
 {
@@ -37,7 +55,27 @@ bool __attribute__((section(".text.opsy.start"))) Scheduler::start(IdleTaskContr
 	CortexM::setIsrHandler(CortexM::SystemIrq::ServiceCall, ::SVC_Handler);
 
 	assert(coreClock % ratio == 0u); // for exact time clock the core clock divided by ratio should not leave a remainder
-	CortexM::enableSystick(coreClock / ratio);
+	s_tickCycles = coreClock / ratio;
+
+	if constexpr (kCpuAccounting)
+	{
+		assert(static_cast<uint64_t>(kCpuLoadWindow.count()) * s_tickCycles <= UINT32_MAX); // the cycles of a window are counted on 32 bits
+		CortexM::enableCycleCount();
+		s_account = &idle.m_cpu; // the first switch is charged to idle
+		s_accountMark = CortexM::cycleCount();
+	}
+
+#if !defined(OPSY_POSIX)
+	if constexpr (kPaintStacks && kMainStackSize != 0)
+	{
+		const auto base = CortexM::mspAtReset() - kMainStackSize;
+		const auto top = CortexM::getMsp() - 32; // main still runs on it, keep some room for the frames below this one
+		assert(top > base); // main already used more than kMainStackSize
+		s_mainWatermark.paint(base, top - base);
+	}
+#endif
+
+	CortexM::enableSystick(s_tickCycles);
 
 	Hooks::starting(idle, coreClock, [](Callback<void(const TaskControlBlock&)> callback)
 	{
@@ -52,7 +90,7 @@ bool __attribute__((section(".text.opsy.start"))) Scheduler::start(IdleTaskContr
 	return doSwitch();
 }
 
-bool __attribute__((section(".text.opsy.doswitch"))) Scheduler::doSwitch()
+bool __attribute__((section(".text.opsy.doswitch"))) Scheduler::doSwitch(bool rotate)
 {
 	assert(s_isStarted);
 	assert((s_currentTask != nullptr) || (s_criticalSection == false)); // can't have no current task in critical section
@@ -63,23 +101,41 @@ bool __attribute__((section(".text.opsy.doswitch"))) Scheduler::doSwitch()
 		return false;
 	}
 
+	if (s_dispatched != nullptr && (s_currentTask == s_dispatched || s_nextTask == s_dispatched))
+		return false; // a time-triggered job keeps the processor until it ends
+
 	if (s_nextTask != nullptr)
 	{
 		assert(s_currentTask != s_nextTask);
 
-		s_ready.insertWhen(TaskControlBlock::priorityIsLower, *s_nextTask);
+		s_ready.insertFront(*s_nextTask); // it was at the front of the ready queue when it was selected
 		s_nextTask = nullptr;
 	}
 
+	if (s_currentTask != nullptr && !rotate && s_dispatched == nullptr && s_currentTask->m_running && s_currentTask->m_preemptionThreshold != Priority::Lowest && !s_ready.empty()
+			&& !(s_ready.front().priority() < s_currentTask->m_preemptionThreshold))
+		return false; // nothing ready above its preemption threshold, it keeps running
+
 	const auto current = s_currentTask;
 
 	if (s_currentTask != nullptr)
 	{
-		s_ready.insertWhen(TaskControlBlock::priorityIsLower, *s_currentTask);
+		if (s_currentTask->m_ceiling != Priority::Lowest || (s_currentTask->m_running && s_currentTask->m_preemptionThreshold != Priority::Lowest)) // it holds a CeilingMutex or runs above its priority, the tasks sharing this priority must not go first, even if it yields
+			s_ready.insertFront(*s_currentTask);
+		else if (rotate) // yield or end of its time slice, it goes behind its peers
+			s_ready.insertBack(*s_currentTask);
+		else
+			s_ready.insert(*s_currentTask);
 		s_currentTask = nullptr;
 	}
 
-	if (s_ready.empty())
+	if (s_dispatched != nullptr) // a time-triggered job was just dispatched, it is not in the ready queue
+	{
+		s_nextTask = s_dispatched;
+		CortexM::triggerPendSv();
+		return true;
+	}
+	else if (s_ready.empty())
 	{
 		CortexM::triggerPendSv();
 		return true;
@@ -93,6 +149,7 @@ bool __attribute__((section(".text.opsy.doswitch"))) Scheduler::doSwitch()
 		{
 			s_currentTask = s_nextTask;
 			s_nextTask = nullptr;
+			startRun(*s_currentTask);
 			return false;
 		}
 		else
@@ -103,6 +160,59 @@ bool __attribute__((section(".text.opsy.doswitch"))) Scheduler::doSwitch()
 	}
 }
 
+void __attribute__((section(".text.opsy.stretchtick"))) Scheduler::stretchTick()
+{
+	assert(s_stretchedTicks == 1);
+
+	int32_t ticks = static_cast<int32_t>(CortexM::systickMaxReload() / s_tickCycles); // the longest period the Systick can do
+
+	if (const auto deadline = s_timeouts.nextDeadline())
+		ticks = std::min(ticks, (deadline.value() - s_ticks).count()); // wake up on the tick of the next timeout
+
+	if (s_table != nullptr)
+		ticks = std::min(ticks, (nextDispatch() - s_ticks).count()); // and on the tick of the next dispatch
+
+	if (ticks <= 1) // next tick is needed anyway
+		return;
+
+	CortexM::stopSystick();
+
+	if (CortexM::isSystickPending()) // the tick ended right before the counter stopped, let it be handled normally
+	{
+		CortexM::resumeSystick();
+		return;
+	}
+
+	const auto elapsed = CortexM::systickCount(); // cycles already spent in the current tick
+	s_stretchedTicks = static_cast<uint32_t>(ticks);
+	CortexM::restartSystick(static_cast<uint32_t>(ticks) * s_tickCycles - elapsed, s_tickCycles); // this period ends on a tick boundary, then the counter goes back to a single tick period
+}
+
+void __attribute__((section(".text.opsy.unstretchtick"))) Scheduler::unstretchTick()
+{
+	if (s_stretchedTicks == 1)
+		return;
+
+	CortexM::stopSystick();
+
+	if (CortexM::isSystickPending()) // the stretched period just ended, Systick will credit it
+	{
+		CortexM::resumeSystick();
+		return;
+	}
+
+	const uint32_t elapsed = s_stretchedTicks * s_tickCycles - 1 - CortexM::systickValue(); // cycles since the last tick that was credited
+	s_ticks += duration(static_cast<int32_t>(elapsed / s_tickCycles));
+	s_stretchedTicks = 1;
+	CortexM::restartSystick(s_tickCycles - elapsed % s_tickCycles, s_tickCycles); // finish the current tick, then go back to a single tick period
+}
+
+#if defined(OPSY_POSIX)
+void Scheduler::terminateTask(TaskControlBlock* task)
+{
+	serviceCall<ServiceCallNumber::Terminate>(reinterpret_cast<uintptr_t>(task));
+}
+#else
 void __attribute__((naked)) Scheduler::terminateTask(TaskControlBlock* task)
 {
 	asm volatile(
@@ -113,19 +223,25 @@ void __attribute__((naked)) Scheduler::terminateTask(TaskControlBlock* task)
 			: [immediate] "I" (ServiceCallNumber::Terminate), [task] "r" (task)
 			: "r0");
 }
+#endif
 
 
 
 
 
-void __attribute__((section(".text.opsy.wakeup"))) Scheduler::wakeUp(TaskControlBlock& task, ConditionVariable& condition)
+bool __attribute__((section(".text.opsy.wakeupfirst"))) Scheduler::wakeUpFirst(ConditionVariable& condition)
 {
-	auto previous = CortexM::setBasepri(kServiceCallPriority); // get a lock up to service call
-	assert(task.m_waiting == &condition); // check the condition is the one the task was waiting for
+	return wakeUpFirst(condition, [](WaitNode&) { }); // nothing to hand over
+}
 
-	condition.removeWaiting(task);
-	task.m_waiting = nullptr;
-	task.setReturnValue(static_cast<uint32_t>(std::cv_status::no_timeout)); // set the return value to no timeout
+void __attribute__((section(".text.opsy.release"))) Scheduler::release(WaitNode& node, uint32_t result)
+{
+	auto& task = *node.m_task;
+	assert(task.m_waiting != nullptr); // check the task is waiting
+
+	node.m_fired = true;
+	stopWaiting(task);
+	task.setReturnValue(result);
 
 	if(task.m_waitUntil.has_value()) // task was also waiting for a timeout
 	{
@@ -133,29 +249,118 @@ void __attribute__((section(".text.opsy.wakeup"))) Scheduler::wakeUp(TaskControl
 		s_timeouts.erase(task);
 	}
 
-	s_ready.insertWhen(TaskControlBlock::priorityIsLower, task);
-	doSwitch(); // ask for a switch if needed (released a task with higher priority)
+	activate(task, s_ticks + stretchedElapsed()); // the ticks of a stretched idle period are not credited yet
+	s_ready.insert(task);
+}
+
+void __attribute__((section(".text.opsy.stopwaiting"))) Scheduler::stopWaiting(TaskControlBlock& task)
+{
+	for (auto node = task.m_waiting; node != nullptr; node = node->m_nextInWait) // it leaves every list it waits in
+		node->m_condition->removeWaiting(*node);
+	task.m_waiting = nullptr;
+}
+
+void __attribute__((section(".text.opsy.notify"))) Scheduler::notify(TaskControlBlock& task, NotifyAction action, uint32_t value)
+{
+	auto previous = CortexM::setBasepri(kServiceCallPriority); // get a lock up to service call
+
+	switch (action)
+	{
+	case NotifyAction::SetBits:
+		task.m_notification |= value;
+		break;
+	case NotifyAction::Increment:
+		++task.m_notification;
+		break;
+	case NotifyAction::Overwrite:
+		task.m_notification = value;
+		break;
+	}
+	task.m_notified = true;
+
+	if(task.m_awaitingNotification) // it waits, release it (nothing to do otherwise, its next wait returns right away)
+	{
+		task.m_awaitingNotification = false;
+		if(task.m_waitUntil.has_value()) // task was also waiting for a timeout
+		{
+			task.m_waitUntil = std::nullopt;
+			s_timeouts.erase(task);
+		}
+
+		activate(task, s_ticks + stretchedElapsed()); // the ticks of a stretched idle period are not credited yet
+		s_ready.insert(task);
+		doSwitch(); // ask for a switch if needed (released a task with higher priority)
+	}
+
 	CortexM::setBasepri(previous); // and restore the basepri to its previous value
 }
 
+uint32_t __attribute__((section(".text.opsy.waitnotification"))) Scheduler::waitNotification()
+{
+	const auto value = takeNotification(std::nullopt);
+	assert(value.has_value()); // without time limit, the wait only ends when it is notified
+	return value.value_or(0);
+}
+
+std::optional<uint32_t> __attribute__((section(".text.opsy.waitnotificationfor"))) Scheduler::waitNotificationFor(duration timeout)
+{
+	return takeNotification(now() + timeout);
+}
+
+std::optional<uint32_t> __attribute__((section(".text.opsy.waitnotificationuntil"))) Scheduler::waitNotificationUntil(time_point timeout_time)
+{
+	return takeNotification(timeout_time);
+}
+
+std::optional<uint32_t> __attribute__((section(".text.opsy.takenotification"))) Scheduler::takeNotification(std::optional<time_point> timeout_time)
+{
+	assert(CortexM::ipsr() == 0); // cannot call in interrupt
+	auto& task = *s_currentTask;
+
+	if (!task.m_notified) // only set by notify, a notification may come before the service call, which checks again
+		serviceCall<ServiceCallNumber::WaitNotification>(static_cast<uintptr_t>(timeout_time.value_or(Startup).time_since_epoch().count()), timeout_time.has_value());
+
+	std::optional<uint32_t> value;
+	auto previous = CortexM::setBasepri(kServiceCallPriority); // notify must not change it while it is consumed
+	if (task.m_notified)
+	{
+		value = task.m_notification;
+		task.m_notification = 0;
+		task.m_notified = false;
+	}
+	CortexM::setBasepri(previous);
+	return value;
+}
+
 void __attribute__((section(".text.opsy.updatepriority"))) Scheduler::updatePriority(TaskControlBlock& task, Priority newPriority)
 {
 	auto previous = CortexM::setBasepri(kServiceCallPriority); // get a lock up to service call
 
+	const bool isReady = task.isStarted() && &task != s_currentTask && &task != s_nextTask && task.m_waiting == nullptr && !task.m_waitUntil.has_value()
+			&& &task != s_dispatched && !task.m_awaitingDispatch && !task.m_awaitingNotification; // task is not current or next, is not waiting for a condition variable, a timeout, a dispatch or a notification, then it is in ready list
+	if(isReady)
+		s_ready.erase(task); // remove the task from ready list before its priority changes, the ready queue may index tasks by priority
+
+	const auto oldPriority = task.m_priority;
 	task.m_priority = newPriority;
 	if(task.isStarted()) // check task is started
 	{
 		if(&task == s_currentTask || &task == s_nextTask) // task is current or next to switch to
-			doSwitch(); // ask for a switch, this will compare priority again with other ready tasks
-		else if(task.m_waiting != nullptr) // task is waiting a condition variable
 		{
-			task.m_waiting->removeWaiting(task); // remove
-			task.m_waiting->addWaiting(task); // then re-insert back the task in the list
+			if(newPriority > oldPriority) // less important, another task may come first (a more important one keeps its place, it must not go behind its new peers)
+				doSwitch(); // ask for a switch, this will compare priority again with other ready tasks
 		}
-		else if(!task.m_waitUntil.has_value()) // task is not current or next, is not waiting for a condition variable, and not waiting for a timeout, then it is in ready list
+		else if(task.m_waiting != nullptr) // task is waiting condition variables
 		{
-			s_ready.erase(task); // remove the task from ready list
-			s_ready.insertWhen(TaskControlBlock::priorityIsLower, task); // then re insert it, this will update its order
+			for (auto node = task.m_waiting; node != nullptr; node = node->m_nextInWait)
+			{
+				node->m_condition->removeWaiting(*node); // remove
+				node->m_condition->addWaiting(*node); // then re-insert back the task in the list
+			}
+		}
+		else if(isReady)
+		{
+			s_ready.insert(task); // re insert the task, this will update its order
 			if(&s_ready.front() == &task) // this brought the task to the first place in the ready list
 				doSwitch(); // so test if it is higher priority than current / next task
 		}
@@ -165,17 +370,149 @@ void __attribute__((section(".text.opsy.updatepriority"))) Scheduler::updatePrio
 	CortexM::setBasepri(previous);
 }
 
-uint64_t __attribute__((section(".text.opsy.isr.pendsv_handler"))) Scheduler::pendSvHandler(uint32_t* psp)
+void __attribute__((section(".text.opsy.setbasepriority"))) Scheduler::setBasePriority(TaskControlBlock& task, Priority basePriority)
+{
+	auto previous = CortexM::setBasepri(kServiceCallPriority); // get a lock up to service call
+
+	task.m_basePriority = basePriority;
+	inheritPriority(task);
+
+	CortexM::setBasepri(previous);
+}
+
+Priority __attribute__((section(".text.opsy.effectivepriority"))) Scheduler::effectivePriority(const TaskControlBlock& task)
+{
+	auto priority = std::min(task.m_basePriority, task.m_ceiling);
+	if (task.m_running)
+		priority = std::min(priority, task.m_preemptionThreshold);
+
+	for (auto mutex = task.m_heldMutexes; mutex != nullptr; mutex = mutex->m_nextHeld)
+		if (!mutex->m_waiters.m_waitingList.empty()) // the waiting list is sorted, the first one is the most important
+			priority = std::min(priority, mutex->m_waiters.m_waitingList.front().m_task->priority());
+
+	return priority;
+}
+
+void __attribute__((section(".text.opsy.inheritpriority"))) Scheduler::inheritPriority(TaskControlBlock& task)
+{
+	// the caller holds the service call lock
+	for (auto current = &task; current != nullptr; current = current->m_blockedOn != nullptr ? current->m_blockedOn->m_owner : nullptr) // follow the chain of owners
+	{
+		const auto priority = effectivePriority(*current);
+		if (priority == current->m_priority) // nothing changes further down the chain
+			break;
+
+		updatePriority(*current, priority); // this also sorts it again in the waiting list it is in
+	}
+}
+
+void __attribute__((section(".text.opsy.acquiremutex"))) Scheduler::acquireMutex(InheritanceMutex& mutex, TaskControlBlock& task)
+{
+	auto previous = CortexM::setBasepri(kServiceCallPriority); // the list of held mutexes may be read by a priority change from an interrupt service routine
+
+	mutex.m_owner = &task;
+	mutex.m_nextHeld = task.m_heldMutexes;
+	task.m_heldMutexes = &mutex;
+
+	CortexM::setBasepri(previous);
+}
+
+void __attribute__((section(".text.opsy.releasemutex"))) Scheduler::releaseMutex(InheritanceMutex& mutex)
+{
+	auto previous = CortexM::setBasepri(kServiceCallPriority); // the next owner must not time out between its choice and its wake up
+	auto& owner = *mutex.m_owner;
+
+	for (auto link = &owner.m_heldMutexes; *link != nullptr; link = &(*link)->m_nextHeld)
+		if (*link == &mutex)
+		{
+			*link = mutex.m_nextHeld;
+			break;
+		}
+	mutex.m_owner = nullptr;
+	mutex.m_nextHeld = nullptr;
+
+	TaskControlBlock* next = nullptr;
+	if (wakeUpFirst(mutex.m_waiters, [&mutex, &next](WaitNode& node) // hand it over to the most important waiter
+		{
+			next = node.m_task;
+			next->m_blockedOn = nullptr;
+			acquireMutex(mutex, *next);
+		}))
+		inheritPriority(*next); // from the ones still waiting
+
+	inheritPriority(owner); // give back what it inherited from this mutex waiters
+	CortexM::setBasepri(previous);
+}
+
+void __attribute__((section(".text.opsy.abandonmutex"))) Scheduler::abandonMutex(InheritanceMutex& mutex, TaskControlBlock& task)
+{
+	auto previous = CortexM::setBasepri(kServiceCallPriority); // get a lock up to service call
+
+	task.m_blockedOn = nullptr;
+	if (mutex.m_owner != nullptr)
+		inheritPriority(*mutex.m_owner);
+
+	CortexM::setBasepri(previous);
+}
+
+bool __attribute__((section(".text.opsy.chargebudget"))) Scheduler::chargeBudget(TaskControlBlock& task)
+{
+	renewBudget(task); // its period may have ended while it ran
+
+	if (task.m_cpu.m_cycles - task.m_budgetStart < static_cast<uint64_t>(task.m_budget.count()) * s_tickCycles)
+		return false;
+
+	if (s_criticalSection || task.m_ceiling != Priority::Lowest || task.m_heldMutexes != nullptr) // parking it would block other tasks, it goes on and the overrun is taken from its next period
+		return false;
+
+	endRun(task);
+	task.m_waitUntil = task.m_replenishAt; // it is parked like a sleeping task, its activation goes on
+	s_timeouts.insert(task);
+	OptionalHooks::budgetExhausted(task);
+	s_currentTask = nullptr;
+	return true;
+}
+
+void __attribute__((section(".text.opsy.setbudget"))) Scheduler::setBudget(TaskControlBlock& task, duration budget, duration period)
+{
+	assert(kCpuAccounting || budget.count() == 0); // the budget is counted by the processor time accounting
+	assert(budget <= period);
+	auto previous = CortexM::setBasepri(kServiceCallPriority); // the Systick must not charge it while it changes
+
+	task.m_budget = budget;
+	task.m_budgetPeriod = period;
+	task.m_budgetStart = task.m_cpu.m_cycles;
+	task.m_replenishAt = s_ticks; // a new period starts when it runs next, or on the next tick if it runs
+
+	CortexM::setBasepri(previous);
+}
+
+void __attribute__((section(".text.opsy.updatepreemptionthreshold"))) Scheduler::updatePreemptionThreshold(TaskControlBlock& task, Priority threshold)
+{
+	auto previous = CortexM::setBasepri(kServiceCallPriority); // get a lock up to service call
+
+	task.m_preemptionThreshold = threshold;
+	if (task.m_running) // it runs or was preempted, the threshold applies right away
+		updatePriority(task, effectivePriority(task)); // this switches if a ready task is now above it
+
+	CortexM::setBasepri(previous);
+}
+
+CortexM::SwitchResult __attribute__((section(".text.opsy.isr.pendsv_handler"))) Scheduler::pendSvHandler(uint32_t* psp)
 {
+	enterKernel(KernelActivity::PendSV); // the outgoing task is charged up to here
 	Hooks::enterPendSv();
 	CortexM::clearPendSv();
 
-	uint64_t result = 0;
+	uint32_t* stackPointer = nullptr;
+	uint32_t basepri = 0;
 
 	if (s_previousTask != nullptr)
 	{
+#if !defined(OPSY_POSIX) // the POSIX port runs tasks on host stacks
 		assert(psp >= s_previousTask->m_stackBase); // Process stack pointer below the task stack base, stack overflow !
 		assert(*s_previousTask->m_stackBase == TaskControlBlock::Dummy); // The lowest slot of the task stack has been modified, this shows a stack overflow
+#endif
 		s_previousTask->m_stackPointer = psp;
 		Hooks::taskStopped(*s_previousTask);
 	}
@@ -185,23 +522,37 @@ uint64_t __attribute__((section(".text.opsy.isr.pendsv_handler"))) Scheduler::pe
 
 	if (s_nextTask == nullptr)
 	{
+		if constexpr (kTicklessIdle)
+			if (s_stretchedTicks == 1)
+				stretchTick();
+
 		s_idling = true;
 		s_previousTask = nullptr;
-		result = reinterpret_cast<uint64_t>(s_idle->m_stackPointer);
+		stackPointer = s_idle->m_stackPointer;
 		Hooks::enterIdle();
 	}
 	else
 	{
+		if constexpr (kTicklessIdle)
+			if (s_idling)
+				unstretchTick(); // the Systick must be back to a single tick period, and the ticks already elapsed credited, before a task runs
+
 		s_idling = false;
 		s_previousTask = s_nextTask;
 		s_currentTask = s_nextTask;
-		result = reinterpret_cast<uint64_t>(s_currentTask->m_stackPointer);
+		if (s_currentTask->m_returnValue.has_value()) // the task was woken up from a service call, now that its context is saved the return value can be written
+			s_currentTask->applyReturnValue();
+
+		stackPointer = s_currentTask->m_stackPointer;
 		s_currentTask->m_lastStarted = s_ticks;
+		startRun(*s_currentTask);
+		if constexpr (kCpuAccounting)
+			renewBudget(*s_currentTask);
 		s_nextTask = nullptr;
 
 		if(s_currentTask->m_mutex != nullptr) // there is a mutex we need to re-acquire before exit
 		{
-			result |= static_cast<uint64_t>(s_currentTask->m_mutex->reLockFromPendSv(CriticalSection(true))) <<32;
+			basepri = s_currentTask->m_mutex->reLockFromPendSv(CriticalSection(true));
 			s_criticalSection = true;
 			s_currentTask->m_mutex = nullptr;
 			Hooks::mutexRestoredForTask(*s_currentTask);
@@ -210,12 +561,21 @@ uint64_t __attribute__((section(".text.opsy.isr.pendsv_handler"))) Scheduler::pe
 		assert(s_currentTask->isStarted());
 		Hooks::taskStarted(*s_currentTask);
 	}
-	return result;
+
+	if constexpr (kCpuAccounting)
+	{
+		auto& account = s_idling ? s_idle->m_cpu : s_currentTask->m_cpu;
+		++account.m_activations;
+		switchAccount(account); // the incoming task is charged from here
+	}
+
+	return CortexM::switchResult(stackPointer, basepri);
 }
 
 void __attribute__((section(".text.opsy.isr.svc_handler"))) Scheduler::serviceCallHandler(StackFrame* frame,
 		ServiceCallNumber parameter, [[maybe_unused]] bool isThread)
 {
+	const auto account = enterKernel(KernelActivity::ServiceCall);
 	Hooks::enterServiceCall();
 	bool taskSwitch = false;
 
@@ -233,6 +593,11 @@ void __attribute__((section(".text.opsy.isr.svc_handler"))) Scheduler::serviceCa
 		if(!task.m_active.exchange(false)) // was not active, abort termination
 			break;
 
+		const bool isReady = &task != s_currentTask && &task != s_nextTask && task.m_waiting == nullptr && !task.m_waitUntil.has_value()
+				&& &task != s_dispatched && !task.m_awaitingDispatch && !task.m_awaitingNotification; // preempted, it is in the ready list
+		if(isReady)
+			s_ready.erase(task);
+
 		s_allTasks.erase(task);
 
 		if(task.m_waitUntil.has_value())
@@ -242,9 +607,26 @@ void __attribute__((section(".text.opsy.isr.svc_handler"))) Scheduler::serviceCa
 		}
 
 		if(task.m_waiting != nullptr)
+			stopWaiting(task);
+		task.m_mutex = nullptr; // released by its wait, it must not be locked again if the task is started again
+
+		task.m_running = false;
+		task.m_priority = effectivePriority(task); // give back the raise of its preemption threshold
+		task.m_deadline = time_point::max(); // a new activation starts if it is started again
+		task.m_awaitingDispatch = false;
+		task.m_awaitingNotification = false;
+		task.m_notified = false; // it starts again with no pending notification
+		task.m_notification = 0;
+		if (&task == s_dispatched)
+			s_dispatched = nullptr;
+
+		assert(task.m_heldMutexes == nullptr); // a task must release its InheritanceMutex before it ends
+		if(task.m_blockedOn != nullptr) // its priority is no longer inherited
 		{
-			task.m_waiting->removeWaiting(task);
-			task.m_waiting = nullptr;
+			const auto mutex = task.m_blockedOn;
+			task.m_blockedOn = nullptr;
+			if (mutex->m_owner != nullptr)
+				inheritPriority(*mutex->m_owner);
 		}
 
 		if (&task == s_currentTask)
@@ -253,6 +635,11 @@ void __attribute__((section(".text.opsy.isr.svc_handler"))) Scheduler::serviceCa
 			s_previousTask = s_currentTask = nullptr;
 			taskSwitch = doSwitch();
 		}
+		else if (&task == s_nextTask) // the switch to it is pending, select another one
+		{
+			s_nextTask = nullptr;
+			taskSwitch = doSwitch();
+		}
 		Hooks::taskTerminated(task);
 		break;
 	}
@@ -265,43 +652,125 @@ void __attribute__((section(".text.opsy.isr.svc_handler"))) Scheduler::serviceCa
 
 		auto delta = duration{static_cast<int32_t>(frame->r0) + 1}; // add one because we want to wait at least the required time
 		assert(delta.count() >= 0);
-		s_currentTask->m_waitUntil = s_ticks + delta;
-		s_timeouts.insertWhen(wakeupAfter, *s_currentTask);
-		Hooks::taskSleep(*s_currentTask);
+		taskSwitch = sleepUntil(s_ticks + delta);
+		break;
+	}
+
+	case ServiceCallNumber::SleepUntil:
+	{
+		assert(isThread); // should not be called from non thread mode
+		assert(!s_criticalSection); // should not be called in critical section
+		assert(s_currentTask != nullptr); // cannot be called if there is no current task running
+
+		const time_point until { duration { static_cast<int32_t>(frame->r0) } };
+		if (until > s_ticks)
+			taskSwitch = sleepUntil(until);
+		else if constexpr (kEdfScheduling) // already passed, it goes on with a new activation
+		{
+			completeActivation(*s_currentTask);
+			activate(*s_currentTask, s_ticks);
+			taskSwitch = doSwitch(); // its new deadline may be later than a ready one
+		}
+		break;
+	}
+
+	case ServiceCallNumber::Switch:
+	{
+		assert(isThread); // should not be called from non thread mode
+		assert(!s_criticalSection); // should not be called in critical section
+		if (s_currentTask != nullptr)
+			endRun(*s_currentTask); // it goes behind its peers at its own priority
+		taskSwitch = doSwitch(true);
+		break;
+	}
+
+	case ServiceCallNumber::WaitNotification:
+	{
+		assert(isThread); // should not be called from non thread mode
+		assert(!s_criticalSection); // should not be called in critical section
+		assert(s_currentTask != nullptr); // cannot be called if there is no current task running
+
+		auto& task = *s_currentTask;
+		if (task.m_notified) // notified since it checked
+			break;
+
+		if (frame->r1 != 0) // with a time limit
+		{
+			const time_point until { duration { static_cast<int32_t>(frame->r0) } };
+			if (until <= s_ticks)
+				break;
+			task.m_waitUntil = until;
+			s_timeouts.insert(task);
+		}
+
+		assert(&task != s_dispatched); // a time-triggered job must not block
+		endRun(task);
+		completeActivation(task);
+		task.m_awaitingNotification = true;
+		Hooks::taskSleep(task);
 		s_currentTask = nullptr;
 		taskSwitch = doSwitch();
 		break;
 	}
 
-	case ServiceCallNumber::Switch:
+	case ServiceCallNumber::WaitDispatch:
 	{
 		assert(isThread); // should not be called from non thread mode
 		assert(!s_criticalSection); // should not be called in critical section
+		assert(s_currentTask != nullptr); // cannot be called if there is no current task running
+
+		auto& task = *s_currentTask;
+		if (&task == s_dispatched) // its job ends
+		{
+			if (!s_dispatchOverrun && CortexM::cycleCount() - s_dispatchStart > s_dispatchBudget)
+				OptionalHooks::scheduleOverrun(task);
+			s_dispatched = nullptr;
+		}
+
+		endRun(task);
+		task.m_awaitingDispatch = true;
+		Hooks::taskSleep(task);
+		s_currentTask = nullptr;
 		taskSwitch = doSwitch();
 		break;
 	}
 
 	case ServiceCallNumber::Wait:
+	case ServiceCallNumber::WaitAny:
 	{
 		assert(isThread); // should not be called from non thread mode
 		assert(frame->r0 != 0); // cannot be called with undefined condition variable
 		assert(s_currentTask != nullptr); // cannot be called if there is no current task running
 
-		ConditionVariable* condition = reinterpret_cast<ConditionVariable*>(frame->r0);
-		duration timeout{frame->r1};
+		WaitNode* nodes = reinterpret_cast<WaitNode*>(frame->r0); // WaitAny, the chained nodes of a WaitSet
+		duration timeout{static_cast<int32_t>(frame->r1)};
 		Mutex* mutex = reinterpret_cast<Mutex*>(frame->r2);
 
+		if(parameter == ServiceCallNumber::Wait) // a single condition variable, the task waits with its own node
+		{
+			nodes = &s_currentTask->m_waitNode;
+			nodes->m_condition = reinterpret_cast<ConditionVariable*>(frame->r0);
+			nodes->m_nextInWait = nullptr;
+		}
+
 		if(timeout.count() >= 0)
 		{
 			s_currentTask->m_waitUntil = s_ticks + timeout;
-			s_timeouts.insertWhen(wakeupAfter, *s_currentTask);
-			Hooks::taskWaitTimeout(*s_currentTask, *condition, s_currentTask->m_waitUntil.value());
-			Hooks::conditionVariableStartWaiting(*condition, *s_currentTask, timeout);
+			s_timeouts.insert(*s_currentTask);
 		}
-		else
+
+		for(auto node = nodes; node != nullptr; node = node->m_nextInWait)
 		{
-			Hooks::taskWait(*s_currentTask, *condition);
-			Hooks::conditionVariableStartWaiting(*condition, *s_currentTask);
+			if(timeout.count() >= 0)
+			{
+				Hooks::taskWaitTimeout(*s_currentTask, *node->m_condition, s_currentTask->m_waitUntil.value());
+				Hooks::conditionVariableStartWaiting(*node->m_condition, *s_currentTask, timeout);
+			}
+			else
+			{
+				Hooks::taskWait(*s_currentTask, *node->m_condition);
+				Hooks::conditionVariableStartWaiting(*node->m_condition, *s_currentTask);
+			}
 		}
 
 		if(mutex != nullptr)
@@ -314,15 +783,166 @@ void __attribute__((section(".text.opsy.isr.svc_handler"))) Scheduler::serviceCa
 			Hooks::mutexStoredForTask(*s_currentTask);
 		}
 
-		condition->addWaiting(*s_currentTask);
-		s_currentTask->m_waiting = condition;
+		auto& task = *s_currentTask;
+		assert(&task != s_dispatched); // a time-triggered job must not block
+		endRun(task);
+		if(task.m_blockedOn == nullptr) // waiting for an InheritanceMutex is part of the activation
+			completeActivation(task);
+		for(auto node = nodes; node != nullptr; node = node->m_nextInWait)
+		{
+			node->m_task = &task;
+			node->m_fired = false;
+			node->m_condition->addWaiting(*node);
+		}
+		task.m_waiting = nodes;
 		s_currentTask = nullptr;
+
+		if(task.m_blockedOn != nullptr) // waiting for an InheritanceMutex, now that it is in the waiting list its owner inherits its priority
+			inheritPriority(*task.m_blockedOn->m_owner);
+
 		taskSwitch = doSwitch();
 		break;
 	}
 
 	}
 	Hooks::exitServiceCall(taskSwitch);
+	exitKernel(account);
+}
+
+bool __attribute__((section(".text.opsy.sleepuntil"))) Scheduler::sleepUntil(time_point until)
+{
+	auto& task = *s_currentTask;
+	assert(&task != s_dispatched); // a time-triggered job must not block
+	endRun(task);
+	completeActivation(task);
+	task.m_waitUntil = until;
+	s_timeouts.insert(task);
+	Hooks::taskSleep(task);
+	s_currentTask = nullptr;
+	return doSwitch();
+}
+
+bool __attribute__((section(".text.opsy.dispatchtable"))) Scheduler::dispatchTable()
+{
+	if (s_dispatched != nullptr && !s_dispatchOverrun && CortexM::cycleCount() - s_dispatchStart > s_dispatchBudget) // still running past its budget
+	{
+		s_dispatchOverrun = true;
+		OptionalHooks::scheduleOverrun(*s_dispatched);
+	}
+
+	bool dispatched = false;
+	while (s_table != nullptr && s_ticks >= nextDispatch())
+	{
+		const auto& entry = (*s_table)[s_tableIndex];
+		if (++s_tableIndex == s_table->size())
+		{
+			s_tableIndex = 0;
+			s_frameStart += s_table->majorFrame();
+		}
+
+		auto& task = *entry.task;
+		if (s_dispatched != nullptr || !task.m_awaitingDispatch) // a job still runs, or the task did not reach its wait yet
+		{
+			OptionalHooks::dispatchMissed(task);
+			continue;
+		}
+
+		task.m_awaitingDispatch = false;
+		s_dispatched = &task;
+		s_dispatchStart = CortexM::cycleCount();
+		s_dispatchBudget = static_cast<uint32_t>(static_cast<uint64_t>(entry.budget.count()) * getCoreClock() / 1000000);
+		s_dispatchOverrun = false;
+		Hooks::taskReady(task);
+		dispatched = true;
+	}
+
+	return dispatched;
+}
+
+void __attribute__((section(".text.opsy.starttable"))) Scheduler::startTable(const ScheduleTable* table)
+{
+	assert(s_isStarted || table == nullptr);
+	auto previous = CortexM::setBasepri(kServiceCallPriority); // the Systick must not dispatch while the table changes
+
+	if (table != nullptr)
+	{
+		CortexM::enableCycleCount();
+		s_tableIndex = 0;
+		s_frameStart = s_ticks + duration(1); // called from a task, the ticks are not stretched
+	}
+	s_table = table;
+
+	CortexM::setBasepri(previous);
+}
+
+CpuUsage __attribute__((section(".text.opsy.cpuusage"))) Scheduler::cpuUsage(const CpuAccount& account)
+{
+	if constexpr (!kCpuAccounting)
+		return CpuUsage { 0, 0, 0 };
+
+	auto previous = CortexM::setBasepri(kServiceCallPriority); // the account must not change while we read it
+
+	uint64_t cycles = account.m_cycles;
+	if (&account == s_account) // it is being charged, add what it used since the last switch
+		cycles += CortexM::cycleCount() - s_accountMark;
+
+	const uint64_t window = static_cast<uint64_t>(kCpuLoadWindow.count()) * s_tickCycles;
+	const uint64_t elapsed = static_cast<uint64_t>((s_ticks - s_windowStart).count()) * s_tickCycles; // in the current window
+	const uint64_t previousLength = static_cast<uint64_t>(s_previousWindow.count()) * s_tickCycles;
+	uint64_t used = cycles - account.m_windowStart;
+	uint64_t span = elapsed;
+
+	if (elapsed < window && previousLength != 0) // the sliding window also covers the end of the previous one, assume its load was even
+	{
+		used += static_cast<uint64_t>(account.m_previousWindow) * (window - elapsed) / previousLength;
+		span = window;
+	}
+
+	const CpuUsage usage { cycles, account.m_activations, static_cast<uint16_t>(span != 0 ? std::min<uint64_t>(1000, used * 1000 / span) : 0) };
+
+	CortexM::setBasepri(previous);
+	return usage;
+}
+
+std::size_t __attribute__((section(".text.opsy.mainstackhighwatermark"))) Scheduler::mainStackHighWaterMark([[maybe_unused]] bool scan)
+{
+#if defined(OPSY_POSIX)
+	return 0;
+#else
+	if (!kPaintStacks || kMainStackSize == 0 || !s_isStarted) // it is painted when the scheduler starts
+		return 0;
+	return kMainStackSize - (scan ? s_mainWatermark.measure(CortexM::mspAtReset() - kMainStackSize) : s_mainWatermark.unused());
+#endif
+}
+
+void __attribute__((section(".text.opsy.scanstacks"))) Scheduler::scanStacks([[maybe_unused]] std::size_t words)
+{
+#if !defined(OPSY_POSIX)
+	if constexpr (kPaintStacks)
+	{
+		auto previous = CortexM::setBasepri(kServiceCallPriority); // a task may start or stop while we walk the list
+		for (auto& task : s_allTasks)
+			task.m_watermark.scan(task.m_stackBase, words);
+		s_idle->m_watermark.scan(s_idle->m_stackBase, words);
+		if constexpr (kMainStackSize != 0)
+			s_mainWatermark.scan(CortexM::mspAtReset() - kMainStackSize, words);
+		CortexM::setBasepri(previous);
+	}
+#endif
+}
+
+void __attribute__((section(".text.opsy.rollcpuwindow"))) Scheduler::rollCpuWindow()
+{
+	switchAccount(*s_account); // charge the current account up to now, so the window ends here for everyone
+
+	for (auto& task : s_allTasks)
+		task.m_cpu.roll();
+	s_idle->m_cpu.roll();
+	for (auto& account : s_kernelAccounts)
+		account.roll();
+
+	s_previousWindow = s_ticks - s_windowStart;
+	s_windowStart = s_ticks;
 }
 
 }
@@ -334,6 +954,18 @@ void __attribute__((section(".text.opsy.isr.systick"))) SysTick_Handler()
 	opsy::Scheduler::SystickHandler();
 }
 
+#if defined(OPSY_POSIX)
+void PendSV_Handler()
+{
+	opsy::CortexM::setBasepri(opsy::Scheduler::kServiceCallPriority);
+	opsy::CortexM::switchContext(opsy::Scheduler::pendSvHandler);
+}
+
+void SVC_Handler()
+{
+	opsy::Scheduler::serviceCallHandler(opsy::CortexM::serviceCallFrame(), static_cast<opsy::Scheduler::ServiceCallNumber>(opsy::CortexM::serviceCallNumber()), opsy::CortexM::serviceCallFromThread());
+}
+#else
 void __attribute__((optimize("O0"), naked, section(".text.opsy.isr.pendsv"))) PendSV_Handler()
 {
 	asm volatile(
@@ -386,4 +1018,5 @@ void __attribute__((optimize("O0"), naked, section(".text.opsy.isr.svc"))) SVC_H
 			:[handler] "g" (opsy::Scheduler::serviceCallHandler)
 			: "r0", "r1", "r2");
 }
+#endif
 }
@@ -58,6 +58,9 @@
 #include "Config.hpp"
 #include "Task.hpp"
 #include "ConditionVariable.hpp"
+#include "ReadyQueue.hpp"
+#include "TimeoutQueue.hpp"
+#include "ScheduleTable.hpp"
 #include "Hooks.hpp"
 
 extern "C" void SysTick_Handler();
@@ -77,9 +80,23 @@ class Scheduler
 	friend void ::PendSV_Handler();
 	friend void ::SVC_Handler();
 	friend void sleep_for(duration t);
+	friend void sleep_until(time_point tp);
 	friend class TaskControlBlock;
+	friend class IdleTaskControlBlock;
 	friend class CriticalSection;
 	friend class ConditionVariable;
+	friend class InheritanceMutex;
+	friend class CeilingMutex;
+	friend class Periodic;
+	friend class ScheduleTable;
+	friend class Semaphore;
+	friend class EventGroup;
+	template<typename T, std::size_t Capacity>
+	friend class SpscRing;
+	template<typename T, std::size_t Capacity>
+	friend class MessageQueue;
+	template<std::size_t Size>
+	friend class WaitSet;
 
 public:
 
@@ -107,6 +124,15 @@ public:
 	 */
 	static bool start(IdleTaskControlBlock& idle = DefaultIdle<>);
 
+	/**
+	 * @brief Checks if the @c Scheduler is started
+	 * @return @c true once @c start returned @c true, @c false before
+	 */
+	static inline bool isStarted()
+	{
+		return s_isStarted;
+	}
+
 	/**
 	 * @brief Gets a read only reference to the @c EmbeddedList of @c Task currently active
 	 * @return A read only reference to the @c EmbeddedList of @c Task currently active
@@ -124,7 +150,24 @@ public:
 	static inline time_point now()
 	{
 		assert(s_isStarted && CortexM::currentPriority().value_or(CortexM::kLowestPriority).value() >= kSystickPriority.value());
-		return s_ticks;
+
+		if constexpr (kTicklessIdle)
+		{
+			time_point ticks;
+			duration stretched;
+
+			do // the Systick may preempt and credit the stretched period while we read, in which case read again
+			{
+				ticks = s_ticks;
+				std::atomic_signal_fence(std::memory_order_seq_cst);
+				stretched = stretchedElapsed();
+				std::atomic_signal_fence(std::memory_order_seq_cst);
+			} while (ticks != s_ticks);
+
+			return ticks + stretched;
+		}
+		else
+			return s_ticks;
 	}
 
 	/**
@@ -144,23 +187,125 @@ public:
 		}
 	}
 
+	/**
+	 * @brief The kernel handlers whose processor time is accounted
+	 */
+	enum class KernelActivity
+		: uint8_t
+		{
+			Systick, ///< The Systick handler (timeouts)
+			ServiceCall, ///< The service call handler (sleep, wait, switch, terminate)
+			PendSV, ///< The PendSV handler (context switch)
+	};
+
+	/**
+	 * @brief Gets a snapshot of the processor time used by a kernel handler
+	 * @param activity The kernel handler
+	 * @return The processor time used, all zeros if @c kCpuAccounting is disabled
+	 */
+	static CpuUsage cpuUsage(KernelActivity activity)
+	{
+		return cpuUsage(s_kernelAccounts[static_cast<std::size_t>(activity)]);
+	}
+
+	/**
+	 * @brief Measures the deepest use of the main stack (the interrupt service routines one) so far
+	 * @param scan @c true to scan the stack now, @c false to get the mark as of the last scan (e.g. by @c scanStacks)
+	 * @return The number of @c uint32_t used at most, @c 0 if stacks are not painted (see @c kStackPainting) or @c kMainStackSize is @c 0
+	 * @remark The main stack is painted when the @c Scheduler starts, what @c main used before is counted as used
+	 */
+	static std::size_t mainStackHighWaterMark(bool scan = true);
+
+	/**
+	 * @brief Refreshes the stack high-water marks a few words at a time, to be called in loop by a custom idle task
+	 * @param words The maximum number of words checked in each stack (every @c Task, the idle task and the main stack)
+	 * @remark It runs with the @c Scheduler locked (@c kServiceCallPriority), so keep @p words small (e.g. 16): it bounds the latency it adds to OpSy interrupts.
+	 * 			Nothing is added to the switch path, and the marks can then be read without scanning (@c stackHighWaterMark with @c false)
+	 */
+	static void scanStacks(std::size_t words);
+
+	/**
+	 * @brief Gives the processor to the other ready @c Task of the same @c Priority, if any
+	 * @remark The calling @c Task goes behind its peers, it runs again when they have run or blocked. When none is ready it returns right away, without a service call
+	 * @remark While it holds a @c CeilingMutex, the peers of its ceiling do not go first, it keeps running
+	 * @warning This should only be called from @c Task and never from interrupt service routine, nor in critical section
+	 */
+	static inline void yield()
+	{
+		auto previous = CortexM::setBasepri(kServiceCallPriority); // the ready queue must not change while we look at it
+		bool peerReady = true;
+		if (s_currentTask != nullptr) // otherwise a switch is already pending, let the service call sort it out
+		{
+			endRun(*s_currentTask); // it yields at its own priority, not at its preemption threshold
+			peerReady = !s_ready.empty() && !(s_currentTask->m_priority < s_ready.front().priority());
+			if (!peerReady)
+				startRun(*s_currentTask);
+		}
+		CortexM::setBasepri(previous);
+
+		if (peerReady)
+			triggerHardSwitch();
+	}
+
+	/**
+	 * @brief Waits for a notification of the calling @c Task (@c TaskControlBlock::notify), as long as needed
+	 * @return The notification value, which is consumed (reset to @c 0)
+	 * @remark It returns right away, without a service call, if the @c Task was notified since its last wait
+	 * @warning This should only be called from @c Task and never from interrupt service routine, nor in critical section
+	 */
+	static uint32_t waitNotification();
+
+	/**
+	 * @brief Waits for a notification of the calling @c Task (@c TaskControlBlock::notify), at most @p timeout
+	 * @param timeout The time limit of the wait
+	 * @return The notification value, which is consumed (reset to @c 0), or @c std::nullopt if @p timeout elapsed first
+	 * @warning This should only be called from @c Task and never from interrupt service routine, nor in critical section
+	 */
+	static std::optional<uint32_t> waitNotificationFor(duration timeout);
+
+	/**
+	 * @brief Waits for a notification of the calling @c Task (@c TaskControlBlock::notify), at most up to @p timeout_time
+	 * @param timeout_time The time limit of the wait
+	 * @return The notification value, which is consumed (reset to @c 0), or @c std::nullopt if @p timeout_time was reached first
+	 * @warning This should only be called from @c Task and never from interrupt service routine, nor in critical section
+	 */
+	static std::optional<uint32_t> waitNotificationUntil(time_point timeout_time);
+
 private:
 
 	enum class ServiceCallNumber
 		: uint8_t
 		{
-			Terminate, Sleep, Switch, Wait,
+			Terminate, Sleep, Switch, Wait, SleepUntil, WaitDispatch, WaitNotification, WaitAny,
 	};
 
 	static bool s_isStarted;
 	static time_point s_ticks;
+	static uint32_t s_tickCycles;
+	static volatile uint32_t s_stretchedTicks;
 	static EmbeddedList<TaskControlBlock, TaskLists::Handle> s_allTasks;
-	static EmbeddedList<TaskControlBlock, TaskLists::Timeout> s_timeouts;
-	static EmbeddedList<TaskControlBlock, TaskLists::Waiting> s_ready;
+	static TimeoutQueue<TaskControlBlock, TaskLists::Timeout> s_timeouts;
+	static ReadyQueue s_ready;
 	static bool s_idling;
 	static bool s_mayNeedSwitch;
 	static volatile bool s_criticalSection;
 
+	static CpuAccount s_kernelAccounts[3];
+	static CpuAccount* s_account;
+	static uint32_t s_accountMark;
+	static time_point s_windowStart;
+	static duration s_previousWindow;
+
+	static StackWatermark s_mainWatermark;
+
+	static const ScheduleTable* s_table;
+	static std::size_t s_tableIndex; // the next entry to dispatch
+	static time_point s_frameStart; // of the major frame the next entry belongs to
+	static TaskControlBlock* s_dispatched; // the time-triggered task whose job runs
+	static uint32_t s_dispatchStart; // cycle count when it was dispatched
+	static uint32_t s_dispatchBudget; // in cycles
+	static bool s_dispatchOverrun; // already reported
+
 	static IdleTaskControlBlock* s_idle;
 	static TaskControlBlock* s_previousTask;
 	static TaskControlBlock* s_currentTask;
@@ -170,7 +315,8 @@ private:
 	{
 		Hooks::taskAdded(task);
 		s_allTasks.push_front(task);
-		s_ready.insertWhen(TaskControlBlock::priorityIsLower, task);
+		activate(task, s_ticks);
+		s_ready.insert(task);
 		if(s_isStarted)
 			triggerSoftSwitch();
 	}
@@ -188,52 +334,277 @@ private:
 
 	static __attribute__((always_inline)) void triggerHardSwitch()
 	{
-		asm volatile("svc %[immediate]" : : [immediate] "I" (ServiceCallNumber::Switch));
+		serviceCall<ServiceCallNumber::Switch>();
+	}
+
+	template<ServiceCallNumber Number>
+	static __attribute__((always_inline)) uintptr_t serviceCall(uintptr_t r0 = 0, uintptr_t r1 = 0, uintptr_t r2 = 0)
+	{
+		return CortexM::serviceCall<static_cast<uint8_t>(Number)>(r0, r1, r2);
 	}
 
-	static constexpr bool wakeupAfter(const TaskControlBlock& left, const TaskControlBlock& right)
+	static bool doSwitch(bool rotate = false);
+
+	/**
+	 * @brief Called when @p task gets the processor, its preemption threshold applies from now on
+	 */
+	static inline void startRun(TaskControlBlock& task)
 	{
-		assert(left.m_waitUntil.has_value() && right.m_waitUntil.has_value());
-		return left.m_waitUntil.value_or(Startup) < right.m_waitUntil.value_or(Startup);
+		task.m_running = true;
+		if (task.m_preemptionThreshold < task.m_priority)
+			task.m_priority = task.m_preemptionThreshold; // it is in no list, no need to sort it again
 	}
 
-	static bool doSwitch();
+	/**
+	 * @brief Called when the current @p task blocks or yields, its preemption threshold no longer applies
+	 */
+	static inline void endRun(TaskControlBlock& task)
+	{
+		task.m_running = false;
+		if (task.m_preemptionThreshold != Priority::Lowest)
+			task.m_priority = effectivePriority(task); // it is in no list yet, no need to sort it again
+	}
+
+	/**
+	 * @brief Called when @p task becomes ready, it starts a new activation unless it is still in one (it waited for an @c InheritanceMutex)
+	 */
+	static inline void activate(TaskControlBlock& task, time_point now)
+	{
+		if constexpr (kEdfScheduling)
+			if (task.m_deadline == time_point::max() && task.m_relativeDeadline.count() > 0)
+				task.m_deadline = now + task.m_relativeDeadline; // before it is inserted, the ready queue sorts by deadline
+	}
+
+	/**
+	 * @brief Called when the current @p task sleeps or waits, its activation is complete
+	 */
+	static inline void completeActivation(TaskControlBlock& task)
+	{
+		if constexpr (kEdfScheduling)
+		{
+			if (task.m_deadline < s_ticks)
+				OptionalHooks::deadlineMissed(task);
+			task.m_deadline = time_point::max();
+		}
+	}
+
+	/**
+	 * @brief Starts a new budget period for @p task if the previous one ended, what it used over its budget is taken from the new one
+	 */
+	static inline void renewBudget(TaskControlBlock& task)
+	{
+		if (task.m_budget.count() == 0 || s_ticks < task.m_replenishAt)
+			return;
+
+		const uint64_t budget = static_cast<uint64_t>(task.m_budget.count()) * s_tickCycles;
+		const uint64_t used = task.m_cpu.m_cycles - task.m_budgetStart;
+		task.m_budgetStart = task.m_cpu.m_cycles - (used > budget ? used - budget : 0);
+		task.m_replenishAt = s_ticks + task.m_budgetPeriod;
+	}
+
+	static bool chargeBudget(TaskControlBlock& task);
+
+	static inline time_point nextDispatch()
+	{
+		return s_frameStart + (*s_table)[s_tableIndex].offset;
+	}
+
+	static bool dispatchTable();
+	static void startTable(const ScheduleTable* table);
+	static void setBudget(TaskControlBlock& task, duration budget, duration period);
+
+	static void stretchTick();
+	static void unstretchTick();
+
+	static duration stretchedElapsed()
+	{
+		const uint32_t stretched = s_stretchedTicks;
+		if (stretched == 1)
+			return duration(0);
+		return duration(static_cast<int32_t>((stretched * s_tickCycles - 1 - CortexM::systickValue()) / s_tickCycles)); // the stretched period started on the last tick, the counter started at the end of the period
+	}
+
+	/**
+	 * @brief Charges the cycles elapsed since the last switch to the account being charged, then starts charging @p account
+	 * @param account The account to charge from now on
+	 * @return The account that was being charged
+	 */
+	static inline __attribute__((always_inline)) CpuAccount* switchAccount(CpuAccount& account)
+	{
+		const auto now = CortexM::cycleCount();
+		const auto previous = s_account;
+		previous->charge(now - s_accountMark);
+		s_accountMark = now;
+		s_account = &account;
+		return previous;
+	}
+
+	static inline __attribute__((always_inline)) CpuAccount* enterKernel(KernelActivity activity)
+	{
+		if constexpr (kCpuAccounting)
+		{
+			auto& account = s_kernelAccounts[static_cast<std::size_t>(activity)];
+			++account.m_activations;
+			return switchAccount(account);
+		}
+		else
+			return nullptr;
+	}
+
+	static inline __attribute__((always_inline)) void exitKernel(CpuAccount* previous)
+	{
+		if constexpr (kCpuAccounting)
+			switchAccount(*previous);
+	}
+
+	static CpuUsage cpuUsage(const CpuAccount& account);
+	static void rollCpuWindow();
 
 	static void __attribute__((always_inline)) SystickHandler()
 	{
+		const auto account = enterKernel(KernelActivity::Systick);
 		Hooks::enterSystick();
-		s_ticks+=duration(1); // this is correct and "atomic" because nothing that has preemptive level above system should use it
+
+		if constexpr (kTicklessIdle)
+		{
+			s_ticks += duration(static_cast<int32_t>(s_stretchedTicks)); // the period that just ended may have been stretched over several ticks
+			s_stretchedTicks = 1; // the counter automatically reloads a single tick period after a stretched one
+		}
+		else
+			s_ticks+=duration(1); // this is correct and "atomic" because nothing that has preemptive level above system should use it
 
 		bool dirty = false;
 
 
-		while(!s_timeouts.empty() && s_timeouts.front().m_waitUntil.value() <= s_ticks)
+		while(TaskControlBlock* expired = s_timeouts.expired(s_ticks))
 		{
-			auto& task = s_timeouts.front();
-			s_timeouts.pop_front();
+			auto& task = *expired;
 			task.m_waitUntil = std::nullopt;
+			task.m_awaitingNotification = false; // if it waited for a notification, it finds none
 
 			if(task.m_waiting != nullptr)
 			{
-				task.m_waiting->removeWaiting(task);
+				stopWaiting(task);
 				task.setReturnValue(static_cast<uint32_t>(std::cv_status::timeout)); // notify timeout to thread (write value to its R0 frame)
+
+				if(task.m_blockedOn != nullptr) // it gave up an InheritanceMutex, its owner no longer inherits its priority, right now
+					abandonMutex(*task.m_blockedOn, task);
 			}
 
-			s_ready.insertWhen(TaskControlBlock::priorityIsLower, task);
+			activate(task, s_ticks);
+			s_ready.insert(task);
 			Hooks::taskReady(task);
 			dirty = true;
 		}
 
-		if(dirty)
-			Hooks::exitSystick(doSwitch());
+		if ((s_table != nullptr || s_dispatched != nullptr) && dispatchTable())
+			dirty = true;
+
+		if constexpr (kCpuAccounting)
+		{
+			if (s_currentTask != nullptr && s_currentTask != s_dispatched && s_currentTask->m_budget.count() != 0 && chargeBudget(*s_currentTask)) // it is charged up to this handler
+				dirty = true;
+
+			if (s_ticks - s_windowStart >= kCpuLoadWindow)
+				rollCpuWindow();
+		}
+
+		bool rotate = false;
+		if constexpr (kTimeSlicing)
+			rotate = sliceExpired();
+
+		if(dirty || rotate)
+			Hooks::exitSystick(doSwitch(rotate));
 		else
+		{
+			if constexpr (kTicklessIdle)
+				if (s_idling && s_nextTask == nullptr) // still idle, chain another stretched period
+					stretchTick();
+
 			Hooks::exitSystick(false);
+		}
+		exitKernel(account);
+	}
+
+	/**
+	 * @brief Checks if the current @c Task used its time slice while a @c Task of the same @c Priority is ready
+	 * @remark A @c Task holding a @c CeilingMutex or running under its preemption threshold is not sliced, the peers of its raised @c Priority must not run before it lowers it
+	 */
+	static inline bool sliceExpired()
+	{
+		const auto task = s_currentTask;
+		if (task == nullptr || s_criticalSection || s_ready.empty())
+			return false;
+		if (task->m_ceiling != Priority::Lowest || (task->m_running && task->m_preemptionThreshold != Priority::Lowest))
+			return false;
+		if (s_ticks - task->m_lastStarted < timeSlice(static_cast<uint8_t>(task->m_priority)))
+			return false;
+		return !(task->m_priority < s_ready.front().priority()); // a more important one would already run
 	}
 
-	static uint64_t pendSvHandler(uint32_t* psp);
+	static bool sleepUntil(time_point until);
+	static CortexM::SwitchResult pendSvHandler(uint32_t* psp);
 	static void serviceCallHandler(StackFrame* frame, ServiceCallNumber parameter, bool isThread);
-	static void wakeUp(TaskControlBlock& task, ConditionVariable& initiator);
+	static bool wakeUpFirst(ConditionVariable& condition);
+	static void release(WaitNode& node, uint32_t result);
+	static void stopWaiting(TaskControlBlock& task);
+
+	/**
+	 * @brief Wakes up the most important @c TaskControlBlock waiting for @p condition, if any, once @p handOver gave it what it waits for
+	 * @param condition The @c ConditionVariable it waits for
+	 * @param handOver Called with the @c WaitNode of the @c TaskControlBlock in @p condition, with the @c Scheduler locked, before it is released (its wait ends with no timeout)
+	 * @return @c true if a @c TaskControlBlock was woken up, @c false if none waits
+	 */
+	template<typename HandOver>
+	static bool wakeUpFirst(ConditionVariable& condition, HandOver&& handOver)
+	{
+		auto previous = CortexM::setBasepri(kServiceCallPriority); // the Systick may time out a waiting task, check the list with the same lock
+		const bool woken = !condition.m_waitingList.empty();
+		if (woken)
+		{
+			auto& node = condition.m_waitingList.front();
+			handOver(node);
+			release(node, static_cast<uint32_t>(std::cv_status::no_timeout));
+			doSwitch();
+		}
+		CortexM::setBasepri(previous);
+		return woken;
+	}
+
+	/**
+	 * @brief Wakes up every @c TaskControlBlock waiting for @p condition that @p satisfied accepts, with a single switch request
+	 * @param condition The @c ConditionVariable they wait for
+	 * @param satisfied Called with each waiting @c TaskControlBlock, in @c Priority order, it returns @c true to release it (its wait ends with no timeout)
+	 */
+	template<typename Satisfied>
+	static void wakeUpSatisfied(ConditionVariable& condition, Satisfied&& satisfied)
+	{
+		auto previous = CortexM::setBasepri(kServiceCallPriority); // the Systick may time out a waiting task, walk the list with the same lock
+		bool woken = false;
+		for (auto it = condition.m_waitingList.begin(); it != condition.m_waitingList.end();)
+		{
+			auto& node = *it;
+			++it; // a released task leaves the list
+			if (satisfied(*node.m_task))
+			{
+				release(node, static_cast<uint32_t>(std::cv_status::no_timeout));
+				woken = true;
+			}
+		}
+		if (woken)
+			doSwitch(); // once for all of them
+		CortexM::setBasepri(previous);
+	}
+	static void notify(TaskControlBlock& task, NotifyAction action, uint32_t value);
+	static std::optional<uint32_t> takeNotification(std::optional<time_point> timeout_time);
 	static void updatePriority(TaskControlBlock& task, Priority newPriority);
+	static void setBasePriority(TaskControlBlock& task, Priority basePriority);
+	static void updatePreemptionThreshold(TaskControlBlock& task, Priority threshold);
+	static Priority effectivePriority(const TaskControlBlock& task);
+	static void inheritPriority(TaskControlBlock& task);
+	static void acquireMutex(InheritanceMutex& mutex, TaskControlBlock& task);
+	static void releaseMutex(InheritanceMutex& mutex);
+	static void abandonMutex(InheritanceMutex& mutex, TaskControlBlock& task);
 
 	static void updateName(TaskControlBlock& task)
 	{
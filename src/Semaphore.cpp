@@ -0,0 +1,103 @@
+#include <mutex>
+#include <cassert>
+
+#include "Semaphore.hpp"
+#include "Scheduler.hpp"
+
+namespace opsy
+{
+
+void Semaphore::acquire()
+{
+	[[maybe_unused]] const bool taken = acquire(std::nullopt);
+	assert(taken); // without time limit, the wait only ends when a unit is handed over
+}
+
+bool Semaphore::try_acquire()
+{
+	while (true)
+	{
+		const auto count = CortexM::loadExclusive(&m_count);
+		if ((count & kMaximum) == 0) // nothing to take, maybe a Task already waits
+			return false;
+		if (CortexM::storeExclusive(&m_count, count - 1) == 0)
+			return true;
+	}
+}
+
+bool Semaphore::try_acquire_for(duration timeout)
+{
+	return acquire(Scheduler::now() + timeout);
+}
+
+bool Semaphore::try_acquire_until(time_point timeout_time)
+{
+	return acquire(timeout_time);
+}
+
+bool Semaphore::release()
+{
+	while (true)
+	{
+		const auto count = CortexM::loadExclusive(&m_count);
+		if ((count & kWaiting) != 0) // a Task waits, the count stays 0 and the unit goes to it
+			return handOver();
+		if (count == m_maximum)
+			return false;
+		if (CortexM::storeExclusive(&m_count, count + 1) == 0)
+			return true;
+	}
+}
+
+bool Semaphore::acquire(std::optional<time_point> timeout_time)
+{
+	assert(CortexM::ipsr() == 0); // cannot wait in interrupt
+
+	if (try_acquire())
+		return true;
+
+	std::unique_lock<Mutex> guard(m_guard);
+
+	if (m_count != 0 && m_count != kWaiting) // given between the first try and the lock
+	{
+		--m_count;
+		return true;
+	}
+
+	if (timeout_time.has_value() && timeout_time.value() <= Scheduler::now())
+		return false;
+
+	m_count = kWaiting; // from now on, release hands units over
+	if (!timeout_time.has_value())
+	{
+		m_waiters.wait(m_guard);
+		return true;
+	}
+
+	if (m_waiters.wait_until(m_guard, timeout_time.value()) == std::cv_status::no_timeout) // handed over by release
+		return true;
+
+	if (m_waiters.m_waitingList.empty()) // the last waiting Task, keep what was given meanwhile
+		m_count &= kMaximum;
+	return false;
+}
+
+bool Semaphore::handOver()
+{
+	std::lock_guard<Mutex> guard(m_guard);
+
+	if (Scheduler::wakeUpFirst(m_waiters)) // its wait ends with no timeout, the unit is its own
+	{
+		if (m_waiters.m_waitingList.empty())
+			m_count = 0;
+		return true;
+	}
+
+	const auto count = m_count & kMaximum; // the waiting Task timed out and has not run since
+	if (count == m_maximum)
+		return false;
+	m_count = count + 1;
+	return true;
+}
+
+}
@@ -0,0 +1,158 @@
+/**
+ ******************************************************************************
+ * @file    Semaphore.hpp
+ * @author  Thomas Legrand
+ * @version V0.1
+ * @date    16-October-2026
+ * @brief   Counting semaphore, safe to give from interrupt service routines
+ *
+ * 			This file contains the @c Semaphore class, a counting (or binary)
+ * 			semaphore whose give is safe from interrupt service routines.
+ *
+ * 			A give with no waiting @c Task is a single exclusive load and store
+ * 			of the count, the @c Scheduler is not involved. Otherwise the unit
+ * 			is handed over to the most important waiting @c Task.
+ *
+ ******************************************************************************
+ * @copyright Copyright 2019 Thomas Legrand under the MIT License
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************
+ * @see https://github.com/Otatiaro/OpSy
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <cassert>
+#include <optional>
+
+#include "Config.hpp"
+#include "ConditionVariable.hpp"
+
+namespace opsy
+{
+
+/**
+ * @brief A counting semaphore, a binary one if its maximum is @c 1.
+ * A @c Task takes a unit with @c acquire, waiting (with an optional time limit) for one if the count is @c 0, and @c Task or interrupt service routines give one with @c release.
+ * @remark It is a replacement for @c std::counting_semaphore, and is lighter than a @c ConditionVariable and a @c Mutex protecting a counter, especially when no @c Task waits
+ * @warning Only interrupt service routines at or below @c kPriority can use it
+ */
+class Semaphore
+{
+public:
+
+	/**
+	 * @brief The most important @c IsrPriority allowed to use a @c Semaphore, the one of the @c Mutex protecting the waiting @c Task, just below the @c Scheduler
+	 */
+	static constexpr auto kPriority = IsrPriority::FromPreemptSub<kPreemptionBits>(kOpsyPreemption + 1, 0);
+
+	/**
+	 * @brief The largest maximum count, the high bit of the count tells a @c Task waits
+	 */
+	static constexpr uint32_t kMaximum = 0x7FFFFFFF;
+
+	/**
+	 * @brief Creates a @c Semaphore
+	 * @param initial The initial count
+	 * @param maximum The maximum count, further @c release are ignored (@c 1 for a binary semaphore)
+	 */
+	constexpr explicit Semaphore(uint32_t initial = 0, uint32_t maximum = kMaximum) :
+			m_count(initial), m_maximum(maximum)
+	{
+		assert(maximum > 0 && maximum <= kMaximum && initial <= maximum);
+	}
+
+	Semaphore(const Semaphore&) = delete;
+	void operator=(const Semaphore&) = delete;
+
+	/**
+	 * @brief Takes a unit, waiting as long as needed for one
+	 * @warning This should only be called from @c Task
+	 */
+	void acquire();
+
+	/**
+	 * @brief Takes a unit if there is one
+	 * @return @c true if a unit was taken, @c false otherwise
+	 * @remark It never waits, so interrupt service routines can call it too
+	 */
+	bool try_acquire();
+
+	/**
+	 * @brief Takes a unit, waiting at most @p timeout for one
+	 * @param timeout The time limit of the wait
+	 * @return @c true if a unit was taken, @c false if @p timeout elapsed first
+	 * @warning This should only be called from @c Task
+	 */
+	bool try_acquire_for(duration timeout);
+
+	/**
+	 * @brief Takes a unit, waiting at most up to @p timeout_time for one
+	 * @param timeout_time The time limit of the wait
+	 * @return @c true if a unit was taken, @c false if @p timeout_time was reached first
+	 * @warning This should only be called from @c Task
+	 */
+	bool try_acquire_until(time_point timeout_time);
+
+	/**
+	 * @brief Gives a unit, handing it over to the most important waiting @c Task if any
+	 * @return @c true if the unit was given, @c false if the count was already at its maximum (a binary @c Semaphore already given)
+	 * @remark It can be called from a @c Task or an interrupt service routine, when no @c Task waits it does not involve the @c Scheduler
+	 */
+	bool release();
+
+	/**
+	 * @brief Gets the current count
+	 * @return The number of units available, @c 0 if a @c Task waits
+	 */
+	uint32_t count() const
+	{
+		return m_count & kMaximum;
+	}
+
+	/**
+	 * @brief Gets the maximum count
+	 * @return The maximum count
+	 */
+	constexpr uint32_t maximum() const
+	{
+		return m_maximum;
+	}
+
+private:
+
+	static constexpr uint32_t kWaiting = ~kMaximum; // set while a Task waits, the count is then 0
+
+	Mutex m_guard { kPriority }; // nothing may give between the check and the wait
+	ConditionVariable m_waiters;
+	uint32_t m_count; // only changed by exclusive load and store, or with m_guard locked while a Task waits
+	const uint32_t m_maximum;
+
+	bool acquire(std::optional<time_point> timeout_time);
+	bool handOver();
+};
+
+static_assert(kOpsyPreemption + 1 < (1u << kPreemptionBits), "Semaphore needs a preemption level below OpSy for its interrupt service routines");
+
+}
@@ -0,0 +1,318 @@
+/**
+ ******************************************************************************
+ * @file    SpscRing.hpp
+ * @author  Thomas Legrand
+ * @version V0.1
+ * @date    16-October-2026
+ * @brief   Lock-free single producer single consumer ring buffer
+ *
+ * 			This file contains the @c SpscRing class template, a lock-free ring
+ * 			buffer between a single producer and a single consumer, e.g. an
+ * 			interrupt service routine streaming bytes or samples to a @c Task.
+ *
+ * 			Neither side takes a lock to add or remove elements, contiguous spans
+ * 			give zero-copy access to the storage. The consumer may wait for data,
+ * 			it is only woken up when the ring was empty, once per batch.
+ *
+ ******************************************************************************
+ * @copyright Copyright 2019 Thomas Legrand under the MIT License
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************
+ * @see https://github.com/Otatiaro/OpSy
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+#include "Config.hpp"
+#include "ConditionVariable.hpp"
+#include "Scheduler.hpp"
+
+namespace opsy
+{
+
+/**
+ * @brief A lock-free ring buffer between a single producer and a single consumer.
+ * The producer adds elements with @c push, @c write or @c writeSpan and @c commit, the consumer removes them with @c pop, @c read or @c readSpan and @c consume, and may @c wait for some
+ * @tparam T The type of the elements
+ * @tparam Capacity The number of elements it holds, a power of 2
+ * @remark Each side may be a @c Task or an interrupt service routine, as long as there is a single one. No lock is taken, the only shared state is the two indexes
+ * @warning An interrupt service routine producing for a waiting consumer wakes it up, it must be at or below @c kPriority
+ */
+template<typename T, std::size_t Capacity>
+class SpscRing
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of 2");
+	static_assert(Capacity <= (1u << 31), "SpscRing capacity must fit the free running indexes");
+
+public:
+
+	/**
+	 * @brief The most important @c IsrPriority allowed to produce while the consumer waits, the one of the @c Mutex protecting its wait, just below the @c Scheduler
+	 */
+	static constexpr auto kPriority = IsrPriority::FromPreemptSub<kPreemptionBits>(kOpsyPreemption + 1, 0);
+
+	/**
+	 * @brief A contiguous part of the storage
+	 */
+	struct Span
+	{
+		T* data; ///< The first element
+		std::size_t size; ///< The number of elements
+	};
+
+	constexpr SpscRing() = default;
+
+	SpscRing(const SpscRing&) = delete;
+	void operator=(const SpscRing&) = delete;
+
+	/**
+	 * @brief Gets the number of elements it holds
+	 * @return The capacity
+	 */
+	static constexpr std::size_t capacity()
+	{
+		return Capacity;
+	}
+
+	/**
+	 * @brief Gets the number of elements available to the consumer
+	 * @return The number of elements, it may grow meanwhile when called by the consumer, or shrink when called by the producer
+	 */
+	std::size_t size() const
+	{
+		return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * @brief Checks if there is no element available to the consumer
+	 * @return @c true if it is empty
+	 */
+	bool empty() const
+	{
+		return size() == 0;
+	}
+
+	/**
+	 * @brief Gets the free part of the storage following the last element, to be filled then published with @c commit
+	 * @return The contiguous free elements, the span may be shorter than the free room when it wraps (or empty when it is full)
+	 * @warning This should only be called by the producer
+	 */
+	Span writeSpan()
+	{
+		const auto head = m_head.load(std::memory_order_relaxed);
+		const std::size_t free = Capacity - (head - m_tail.load(std::memory_order_acquire));
+		const auto index = head & kMask;
+		return Span { &m_items[index], std::min(free, Capacity - index) };
+	}
+
+	/**
+	 * @brief Publishes elements written in the span given by @c writeSpan
+	 * @param count The number of elements written, at most the size of the span
+	 * @remark The consumer is woken up if it waits
+	 * @warning This should only be called by the producer
+	 */
+	void commit(std::size_t count)
+	{
+		m_head.store(m_head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+		if (m_waiting.load(std::memory_order_relaxed) && m_waiting.exchange(false)) // the consumer waits for the ring to be filled, it is woken up once for the batch
+			Scheduler::wakeUpFirst(m_waiters);
+	}
+
+	/**
+	 * @brief Adds an element
+	 * @param item The element to add
+	 * @return @c true if it was added, @c false if the ring is full
+	 * @warning This should only be called by the producer
+	 */
+	bool push(const T& item)
+	{
+		const auto span = writeSpan();
+		if (span.size == 0)
+			return false;
+		span.data[0] = item;
+		commit(1);
+		return true;
+	}
+
+	/**
+	 * @brief Adds elements, as many as there is room for, and publishes them at once
+	 * @param items The elements to add
+	 * @param count The number of elements to add
+	 * @return The number of elements added
+	 * @warning This should only be called by the producer
+	 */
+	std::size_t write(const T* items, std::size_t count)
+	{
+		std::size_t written = 0;
+		for (auto part = 0; part < 2 && written < count; ++part) // the free room is at most two spans, before and after the end of the storage
+		{
+			const auto head = m_head.load(std::memory_order_relaxed) + written;
+			const std::size_t free = Capacity - (head - m_tail.load(std::memory_order_acquire));
+			const auto index = head & kMask;
+			const auto size = std::min({ free, Capacity - index, count - written });
+			std::copy(items + written, items + written + size, &m_items[index]);
+			written += size;
+		}
+		if (written != 0)
+			commit(written);
+		return written;
+	}
+
+	/**
+	 * @brief Gets the elements available following the first one, to be read then released with @c consume
+	 * @return The contiguous available elements, the span may be shorter than the available elements when they wrap (or empty when there is none)
+	 * @warning This should only be called by the consumer
+	 */
+	Span readSpan()
+	{
+		const auto tail = m_tail.load(std::memory_order_relaxed);
+		const std::size_t used = m_head.load(std::memory_order_acquire) - tail;
+		const auto index = tail & kMask;
+		return Span { &m_items[index], std::min(used, Capacity - index) };
+	}
+
+	/**
+	 * @brief Releases elements read in the span given by @c readSpan, their room goes back to the producer
+	 * @param count The number of elements read, at most the size of the span
+	 * @warning This should only be called by the consumer
+	 */
+	void consume(std::size_t count)
+	{
+		m_tail.store(m_tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Removes the first element
+	 * @param item Receives the element
+	 * @return @c true if an element was removed, @c false if the ring is empty
+	 * @warning This should only be called by the consumer
+	 */
+	bool pop(T& item)
+	{
+		const auto span = readSpan();
+		if (span.size == 0)
+			return false;
+		item = span.data[0];
+		consume(1);
+		return true;
+	}
+
+	/**
+	 * @brief Removes elements, as many as are available
+	 * @param items Receives the elements
+	 * @param count The maximum number of elements to remove
+	 * @return The number of elements removed
+	 * @warning This should only be called by the consumer
+	 */
+	std::size_t read(T* items, std::size_t count)
+	{
+		std::size_t done = 0;
+		for (auto part = 0; part < 2 && done < count; ++part) // the elements are at most two spans, before and after the end of the storage
+		{
+			const auto tail = m_tail.load(std::memory_order_relaxed) + done;
+			const std::size_t used = m_head.load(std::memory_order_acquire) - tail;
+			const auto index = tail & kMask;
+			const auto size = std::min({ used, Capacity - index, count - done });
+			std::copy(&m_items[index], &m_items[index] + size, items + done);
+			done += size;
+		}
+		if (done != 0)
+			consume(done);
+		return done;
+	}
+
+	/**
+	 * @brief Waits for elements, as long as needed
+	 * @remark It returns right away if the ring is not empty, otherwise the consumer sleeps until the producer commits
+	 * @warning This should only be called by the consumer, a @c Task
+	 */
+	void wait()
+	{
+		[[maybe_unused]] const bool filled = wait(std::nullopt);
+		assert(filled); // without time limit, the wait only ends when the producer commits
+	}
+
+	/**
+	 * @brief Waits for elements, at most @p timeout
+	 * @param timeout The time limit of the wait
+	 * @return @c true if there are elements, @c false if @p timeout elapsed first
+	 * @warning This should only be called by the consumer, a @c Task
+	 */
+	bool wait_for(duration timeout)
+	{
+		return wait(Scheduler::now() + timeout);
+	}
+
+	/**
+	 * @brief Waits for elements, at most up to @p timeout_time
+	 * @param timeout_time The time limit of the wait
+	 * @return @c true if there are elements, @c false if @p timeout_time was reached first
+	 * @warning This should only be called by the consumer, a @c Task
+	 */
+	bool wait_until(time_point timeout_time)
+	{
+		return wait(std::optional<time_point>(timeout_time));
+	}
+
+private:
+
+	static constexpr std::size_t kMask = Capacity - 1;
+
+	std::array<T, Capacity> m_items { };
+	std::atomic<uint32_t> m_head { 0 }; // free running, written by the producer
+	std::atomic<uint32_t> m_tail { 0 }; // free running, written by the consumer
+	std::atomic_bool m_waiting { false }; // the consumer waits, the next commit wakes it up
+	Mutex m_guard { kPriority }; // the producer may not commit between the check and the wait
+	ConditionVariable m_waiters;
+
+	bool wait(std::optional<time_point> timeout_time)
+	{
+		assert(CortexM::ipsr() == 0); // cannot wait in interrupt
+
+		if (!empty())
+			return true;
+
+		std::unique_lock<Mutex> guard(m_guard);
+		m_waiting.store(true);
+		if (empty() && !(timeout_time.has_value() && timeout_time.value() <= Scheduler::now()))
+		{
+			if (timeout_time.has_value())
+				m_waiters.wait_until(m_guard, timeout_time.value());
+			else
+				m_waiters.wait(m_guard);
+		}
+		m_waiting.store(false); // it was not woken up if it timed out
+		return !empty();
+	}
+};
+
+}
@@ -0,0 +1,156 @@
+/**
+ ******************************************************************************
+ * @file    StackWatermark.hpp
+ * @author  Thomas Legrand
+ * @version V0.1
+ * @date    16-October-2026
+ * @brief   Stack high-water mark measurement
+ *
+ * 			This file contains @c StackWatermark, which measures how deep a stack
+ * 			has ever been used.
+ *
+ * 			The stack is painted with a known value when it is set up, the words
+ * 			still holding this value at its base have never been used. Stacks are
+ * 			always painted in debug builds (the @c Scheduler checks the lowest word
+ * 			to detect overflows), and in release builds when @c kStackPainting is
+ * 			enabled.
+ *
+ ******************************************************************************
+ * @copyright Copyright 2019 Thomas Legrand under the MIT License
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************
+ * @see https://github.com/Otatiaro/OpSy
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <algorithm>
+
+#include "Config.hpp"
+
+namespace opsy
+{
+
+/**
+ * @brief Whether stacks are painted, i.e. whether their high-water mark can be measured
+ */
+#ifndef NDEBUG
+constexpr bool kPaintStacks = true; // the Scheduler checks the lowest word of each stack to detect overflows
+#else
+constexpr bool kPaintStacks = kStackPainting;
+#endif
+
+/**
+ * @brief Measures how deep a painted stack has ever been used
+ * @remark Stacks grow down, the unused part is found by scanning from the base up to the first word that does not hold @c kPaint.
+ * 			It is scanned word by word rather than by bisection: the used part may hold words never written (a local buffer partly filled, padding),
+ * 			a bisection stopping on one of them would report less than what was actually used
+ * @remark The used part never shrinks, so a scan only goes up to the last known mark, and the idle task can spread it over several steps with @c scan
+ */
+class StackWatermark
+{
+public:
+
+	/**
+	 * @brief The value stacks are painted with
+	 */
+	static constexpr uint32_t kPaint = 0xDEADBEEF;
+
+	constexpr StackWatermark() = default;
+
+	/**
+	 * @brief Paints a stack and forgets what was measured before
+	 * @param base The base (lowest address) of the stack
+	 * @param size The size of the stack, in @c uint32_t increment
+	 */
+	void paint(uint32_t* base, std::size_t size)
+	{
+		std::fill(base, base + size, kPaint);
+		m_unused.store(size, std::memory_order_relaxed);
+		m_cursor = 0;
+	}
+
+	/**
+	 * @brief Scans the whole stack now
+	 * @param base The base (lowest address) of the stack
+	 * @return The number of words at the base of the stack that have never been used
+	 */
+	std::size_t measure(const uint32_t* base)
+	{
+		const auto unused = m_unused.load(std::memory_order_relaxed);
+		const auto found = std::find_if(base, base + unused, [](uint32_t word) { return word != kPaint; });
+		lower(found - base);
+		return m_unused.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Scans the next @p words of the stack, resuming where the previous call stopped
+	 * @param base The base (lowest address) of the stack
+	 * @param words The maximum number of words to check
+	 * @return @c true if the scan reached the used part of the stack (@c unused is up to date), @c false if it has to go on
+	 * @remark Only the idle task should call this, through @c Scheduler::scanStacks
+	 */
+	bool scan(const uint32_t* base, std::size_t words)
+	{
+		const auto unused = m_unused.load(std::memory_order_relaxed);
+		const auto end = std::min(m_cursor + words, unused);
+		const auto found = std::find_if(base + std::min(m_cursor, end), base + end, [](uint32_t word) { return word != kPaint; });
+
+		if (found == base + unused || found != base + end) // reached the mark, or the used part grew below it
+		{
+			lower(found - base);
+			m_cursor = 0;
+			return true;
+		}
+
+		m_cursor = end;
+		return false;
+	}
+
+	/**
+	 * @brief Gets the number of words at the base of the stack never used, as of the last scan
+	 * @return The number of words never used
+	 */
+	std::size_t unused() const
+	{
+		return m_unused.load(std::memory_order_relaxed);
+	}
+
+private:
+
+	std::atomic<std::size_t> m_unused { 0 }; // a task may measure while the idle task scans, the mark can only go down
+	std::size_t m_cursor = 0;
+
+	void lower(std::size_t unused)
+	{
+		auto current = m_unused.load(std::memory_order_relaxed);
+		while (unused < current && !m_unused.compare_exchange_weak(current, unused, std::memory_order_relaxed))
+			;
+	}
+};
+
+}
@@ -1,5 +1,3 @@
-#include <algorithm>
-
 #include "Task.hpp"
 #include "Scheduler.hpp"
 
@@ -12,10 +10,16 @@ bool TaskControlBlock::start(Callback<void(void)> && entry, const char* name)
 
 	m_entry = std::move(entry);
 	m_name = name;
+	m_returnValue = std::nullopt; // it may have been woken up right before being stopped
 
-#ifndef NDEBUG
-	std::fill(m_stackBase, m_stackBase + m_stackSize, Dummy);
-#endif
+#if defined(OPSY_POSIX)
+	m_stackPointer = CortexM::prepareStack(m_stackBase, [](void* task)
+	{
+		taskStarter(static_cast<TaskControlBlock*>(task));
+	}, this);
+#else
+	if constexpr (kPaintStacks)
+		m_watermark.paint(m_stackBase, m_stackSize);
 
 	m_stackPointer = &m_stackBase[m_stackSize - 1]; // this pointer is reserved to stop stack trace unwinding
 	m_stackBase[m_stackSize - 1] = 0; // keep this pointer to zero to stop stack trace
@@ -32,6 +36,7 @@ bool TaskControlBlock::start(Callback<void(void)> && entry, const char* name)
 	const auto context = reinterpret_cast<Context*>(m_stackPointer);
 	context->control = 0b10;
 	context->lr = 0xFFFFFFFD;
+#endif
 
 	Scheduler::addTask(*this);
 	return true;
@@ -42,23 +47,67 @@ bool TaskControlBlock::stop()
 	if(!isStarted()) // can only stop an active task
 		return false;
 
-	asm volatile(
-			"mov r0, %[task] \n\t"
-			"svc %[immediate]"
-			:
-			: [immediate] "I" (Scheduler::ServiceCallNumber::Terminate), [task] "r" (this)
-			: "r0");
+	Scheduler::serviceCall<Scheduler::ServiceCallNumber::Terminate>(reinterpret_cast<uintptr_t>(this));
 	return true;
 }
 
 void TaskControlBlock::priority(Priority newPriority)
 {
-	if(newPriority == m_priority)
+	if(newPriority == m_basePriority)
+		return;
+	else
+		Scheduler::setBasePriority(*this, newPriority);
+}
+
+void TaskControlBlock::preemptionThreshold(Priority threshold)
+{
+	if(threshold == m_preemptionThreshold)
 		return;
 	else
-		Scheduler::updatePriority(*this, newPriority);
+		Scheduler::updatePreemptionThreshold(*this, threshold);
+}
+
+void TaskControlBlock::budget(duration budget, duration period)
+{
+	Scheduler::setBudget(*this, budget, period);
+}
+
+void TaskControlBlock::notify(NotifyAction action, uint32_t value)
+{
+	Scheduler::notify(*this, action, value);
 }
 
+CpuUsage TaskControlBlock::cpuUsage() const
+{
+	return Scheduler::cpuUsage(m_cpu);
+}
+
+CpuUsage IdleTaskControlBlock::cpuUsage() const
+{
+	return Scheduler::cpuUsage(m_cpu);
+}
+
+std::size_t TaskControlBlock::stackHighWaterMark([[maybe_unused]] bool scan) const
+{
+#if defined(OPSY_POSIX)
+	return 0;
+#else
+	if (!kPaintStacks || m_stackPointer == nullptr) // never started, the stack is not painted yet
+		return 0;
+	return m_stackSize - (scan ? m_watermark.measure(m_stackBase) : m_watermark.unused());
+#endif
+}
+
+std::size_t IdleTaskControlBlock::stackHighWaterMark([[maybe_unused]] bool scan) const
+{
+#if defined(OPSY_POSIX)
+	return 0;
+#else
+	if constexpr (!kPaintStacks)
+		return 0;
+	return m_stackSize - (scan ? m_watermark.measure(m_stackBase) : m_watermark.unused());
+#endif
+}
 
 void TaskControlBlock::taskStarter(TaskControlBlock* thisPtr)
 {
@@ -52,6 +52,8 @@
 #include "EmbeddedList.hpp"
 #include "CortexM.hpp"
 #include "Callback.hpp"
+#include "CpuUsage.hpp"
+#include "StackWatermark.hpp"
 //#include "Mutex.hpp"
 
 namespace opsy
@@ -71,6 +73,17 @@ enum class Priority
 	Highest = 0x0, ///< Highest priority
 };
 
+/**
+ * @brief How @c TaskControlBlock::notify updates the notification value
+ */
+enum class NotifyAction
+	: uint8_t
+	{
+		SetBits, ///< Sets the given bits, e.g. one bit per event
+	Increment, ///< Adds one, e.g. a count of units to process (the given value is ignored)
+	Overwrite, ///< Replaces the value, e.g. the latest sample
+};
+
 class TaskControlBlock;
 
 namespace TaskLists
@@ -85,19 +98,54 @@ class Handle: public EmbeddedNode<TaskControlBlock>
 
 };
 
-class Waiting: public EmbeddedNode<TaskControlBlock>
+class Ready: public EmbeddedNode<TaskControlBlock>
 {
 
 };
 
 }
 
+class ConditionVariable;
+
+/**
+ * @brief The place of a waiting @c TaskControlBlock in the waiting list of a @c ConditionVariable
+ * @remark A @c TaskControlBlock has its own to wait for a single @c ConditionVariable, a @c WaitSet has one per member, so the @c TaskControlBlock waits in all their lists at once
+ */
+class WaitNode: public EmbeddedNode<WaitNode>
+{
+	friend class Scheduler;
+	friend class ConditionVariable;
+	template<typename T, std::size_t Capacity>
+	friend class MessageQueue;
+	template<std::size_t Size>
+	friend class WaitSet;
+
+public:
+
+	constexpr WaitNode() = default;
+
+private:
+
+	TaskControlBlock* m_task = nullptr;
+	ConditionVariable* m_condition = nullptr; // the one whose list it is in
+	WaitNode* m_nextInWait = nullptr; // the next one of the same wait, nullptr for the last one
+	void* m_message = nullptr; // the message a MessageQueue takes from it or gives to it
+	bool m_fired = false; // its ConditionVariable ended the wait
+};
+
 /**
  * @brief A pointer to executable code
  */
 using CodePointer = void(*)(void);
 
 
+#if defined(OPSY_POSIX)
+
+using StackFrame = CortexM::StackFrame;
+using Context = CortexM::Context;
+
+#else
+
 namespace
 {
 
@@ -179,13 +227,16 @@ struct FpContext
 
 }
 
-class ConditionVariable;
+#endif
+
+class InheritanceMutex;
+class CeilingMutex;
 
 /**
  * @brief A @c Task control block, that contains all the necessary data to manipulate it
  * @remark You should normally not manipulate this type, only create and manipulate @c Task which inherit from @c TaskControlBlock
  */
-class TaskControlBlock: private TaskLists::Timeout, private TaskLists::Waiting, private TaskLists::Handle
+class TaskControlBlock: private TaskLists::Timeout, private TaskLists::Ready, private TaskLists::Handle
 {
 	template<typename T, typename I>
 	friend class EmbeddedIterator;
@@ -193,6 +244,17 @@ class TaskControlBlock: private TaskLists::Timeout, private TaskLists::Waiting,
 	friend class EmbeddedConstIterator;
 	friend class Scheduler;
 	friend class Hooks;
+	friend class InheritanceMutex;
+	friend class CeilingMutex;
+	friend class EventGroup;
+	template<typename T, std::size_t Capacity>
+	friend class MessageQueue;
+	template<std::size_t Size>
+	friend class WaitSet;
+	template<typename I, typename If>
+	friend class SortedTimeoutQueue;
+	template<typename I, typename If, std::size_t L>
+	friend class TimeoutWheel;
 
 public:
 
@@ -237,20 +299,149 @@ public:
 
 	/**
 	 * @brief Gets the current @c Priority of the @c TaskControlBlock
-	 * @return The current @c Priority of the @c TaskControlBlock
+	 * @return The current @c Priority of the @c TaskControlBlock, including the one it inherits from @c InheritanceMutex waiters and @c CeilingMutex
 	 */
 	constexpr inline Priority priority() const
 	{
 		return m_priority;
 	}
 
+	/**
+	 * @brief Gets the @c Priority given to the @c TaskControlBlock, without inheritance
+	 * @return The @c Priority given to the @c TaskControlBlock
+	 */
+	constexpr inline Priority basePriority() const
+	{
+		return m_basePriority;
+	}
+
+	/**
+	 * @brief Gets a snapshot of the processor time used by the @c TaskControlBlock
+	 * @return The processor time used, all zeros if @c kCpuAccounting is disabled
+	 * @remark Interrupt service routines other than OpSy ones are accounted to the @c TaskControlBlock they preempt
+	 */
+	CpuUsage cpuUsage() const;
+
+	/**
+	 * @brief Measures the deepest use of the @c TaskControlBlock stack so far
+	 * @param scan @c true to scan the stack now, @c false to get the mark as of the last scan (e.g. by @c Scheduler::scanStacks)
+	 * @return The number of @c StackItem used at most, @c 0 if stacks are not painted (see @c kStackPainting) or the @c TaskControlBlock never started
+	 * @remark The stack is scanned from its base up to the first used word, the cost grows with the part of the stack never used (a few cycles per word).
+	 * 			It is not a bound: code paths not run yet may go deeper
+	 * @remark On the POSIX port @c Task run on host stacks, this is always @c 0
+	 */
+	std::size_t stackHighWaterMark(bool scan = true) const;
+
+	/**
+	 * @brief Gets the size of the @c TaskControlBlock stack
+	 * @return The size of the stack, in @c StackItem increment
+	 */
+	constexpr std::size_t stackSize() const
+	{
+		return m_stackSize;
+	}
+
 	/**
 	 * @brief Dynamically change the @c Priority of the @c TaskControlBlock
 	 * @param newPriority the new @c Priority
 	 * @remark This may trigger a @c TaskControlBlock switch from the system to make sure the most important @c TaskControlBlock is always executed
+	 * @remark While it holds an @c InheritanceMutex, the @c TaskControlBlock keeps running at least at the @c Priority of its most important waiter, and while it holds a @c CeilingMutex at least at its ceiling
 	 */
 	void priority(Priority newPriority);
 
+	/**
+	 * @brief Gets the preemption threshold of the @c TaskControlBlock
+	 * @return The preemption threshold, @c Priority::Lowest if none is set
+	 */
+	constexpr inline Priority preemptionThreshold() const
+	{
+		return m_preemptionThreshold;
+	}
+
+	/**
+	 * @brief Sets the preemption threshold of the @c TaskControlBlock: while it runs, only a @c Task more important than @p threshold can preempt it
+	 * @param threshold The preemption threshold, it has no effect unless more important than the @c TaskControlBlock @c Priority (@c Priority::Lowest to remove it)
+	 * @remark Giving a group of @c Task the same threshold makes them run to completion with respect to each other, which saves context switches between them,
+	 * 			while more important @c Task keep their latency. It does not change when the @c TaskControlBlock starts running, only its @c Priority does
+	 * @remark Once it got the processor, and until it blocks or yields, the @c TaskControlBlock runs at the threshold (@c priority reports it): when preempted, it resumes before the @c Task below the threshold
+	 * @remark @c Scheduler::yield still gives the processor to its peers
+	 */
+	void preemptionThreshold(Priority threshold);
+
+	/**
+	 * @brief Gets the execution budget of the @c TaskControlBlock
+	 * @return The processor time it may use in each budget period, @c duration(0) if it has none
+	 */
+	constexpr inline duration budget() const
+	{
+		return m_budget;
+	}
+
+	/**
+	 * @brief Gets the budget period of the @c TaskControlBlock
+	 * @return The budget period, @c duration(0) if it has no budget
+	 */
+	constexpr inline duration budgetPeriod() const
+	{
+		return m_budgetPeriod;
+	}
+
+	/**
+	 * @brief Limits the processor time used by the @c TaskControlBlock: once it used @p budget in a budget period, it is parked until the period ends, whatever its @c Priority
+	 * @param budget The processor time it may use in each period, @c duration(0) to remove the limit
+	 * @param period The budget period, a new one starts when the @c TaskControlBlock runs after the previous one ended
+	 * @remark The processor time is counted by @c kCpuAccounting, which must be enabled. It is checked on each tick, so a period may use up to a tick more than @p budget
+	 * @remark It is not parked in a critical section nor while it holds a @c CeilingMutex or an @c InheritanceMutex, that would block the other @c Task: the overrun is taken from its next period instead
+	 */
+	void budget(duration budget, duration period);
+
+	/**
+	 * @brief Notifies the @c TaskControlBlock, waking it up if it waits for a notification with @c Scheduler::waitNotification
+	 * @param action How the notification value is updated
+	 * @param value The value to apply
+	 * @remark It can be called from a @c Task or an interrupt service routine. There is no kernel object, no list and no lock to take: it is the lightest way to signal a single consumer
+	 */
+	void notify(NotifyAction action, uint32_t value = 0);
+
+	/**
+	 * @brief Gets the notification value, not consumed yet by @c Scheduler::waitNotification
+	 * @return The notification value
+	 */
+	constexpr inline uint32_t notification() const
+	{
+		return m_notification;
+	}
+
+	/**
+	 * @brief Gets the relative deadline of the @c TaskControlBlock activations
+	 * @return The relative deadline, @c duration(0) if none is set
+	 */
+	constexpr inline duration relativeDeadline() const
+	{
+		return m_relativeDeadline;
+	}
+
+	/**
+	 * @brief Sets the relative deadline of the @c TaskControlBlock activations, used when @c kEdfScheduling is enabled
+	 * @param deadline The relative deadline, @c duration(0) to remove it
+	 * @remark An activation starts when the @c TaskControlBlock starts, or becomes ready after a @c sleep_for, a @c ConditionVariable wait or a notification wait, its deadline is then set @p deadline later.
+	 * 			It ends when the @c TaskControlBlock sleeps or waits again (waiting for an @c InheritanceMutex does not end it), @c Hooks::deadlineMissed is called if its deadline has passed
+	 * @remark It applies from the next activation
+	 */
+	constexpr void relativeDeadline(duration deadline)
+	{
+		m_relativeDeadline = deadline;
+	}
+
+	/**
+	 * @brief Gets the deadline of the current activation of the @c TaskControlBlock
+	 * @return The deadline, @c time_point::max() if there is none (no relative deadline, not activated or @c kEdfScheduling disabled)
+	 */
+	constexpr inline time_point deadline() const
+	{
+		return m_deadline;
+	}
+
 	/**
 	 * @brief Gets the current name of the @c TaskControlBlock
 	 * @return The current name of the @c TaskControlBlock
@@ -274,6 +465,7 @@ public:
 	 * @param left The left operand
 	 * @param right The right operand
 	 * @return @c true if @p left is more important that @p right, @c false otherwise
+	 * @remark With @c kEdfScheduling, the earliest deadline is more important between two @c TaskControlBlock of the same @c Priority
 	 */
 	static constexpr bool priorityIsLower(const TaskControlBlock& left, const TaskControlBlock& right)
 	{
@@ -281,31 +473,76 @@ public:
 			return false;
 		if (left.priority() < right.priority())
 			return true;
+		if constexpr (kEdfScheduling)
+			if (left.m_deadline != right.m_deadline)
+				return left.m_deadline < right.m_deadline;
 		return left.m_lastStarted < right.m_lastStarted;
 	}
 
 private:
 
-	static constexpr uint32_t Dummy = 0xDEADBEEF;
+	static constexpr uint32_t Dummy = StackWatermark::kPaint;
 
 	StackItem* const m_stackBase;
 	const std::size_t m_stackSize;
 	std::atomic_bool m_active { false };
 	StackItem* m_stackPointer = nullptr;
 	Priority m_priority = Priority::Lowest;
+	Priority m_basePriority = Priority::Lowest;
+	Priority m_ceiling = Priority::Lowest; // the highest ceiling of the CeilingMutex it holds
+	Priority m_preemptionThreshold = Priority::Lowest;
+	bool m_running = false; // got the processor and neither blocked nor yielded since, its preemption threshold applies
+	bool m_awaitingDispatch = false; // waits for its next dispatch by a ScheduleTable
+	bool m_awaitingNotification = false; // waits in Scheduler::waitNotification
+	bool m_notified = false; // notified since the last Scheduler::waitNotification
+	uint8_t m_timeoutSlot = 0;
 	time_point m_lastStarted = Startup;
+	time_point m_deadline = time_point::max(); // of the current activation, max when there is none
+	duration m_relativeDeadline = duration(0);
 	std::optional<time_point> m_waitUntil;
 	const char* m_name = nullptr;
 	Callback<void(void)> m_entry;
-	ConditionVariable* m_waiting = nullptr;
+	uint32_t m_notification = 0;
+	uint32_t m_eventFlags = 0; // the flags it waits for in an EventGroup, then the ones that released it
+	bool m_eventAll = false; // it waits for all of m_eventFlags, not any of them
+	bool m_eventClear = false; // it clears m_eventFlags when released
+	WaitNode* m_waiting = nullptr; // the first node of its wait, nullptr when it waits for no ConditionVariable
+	WaitNode m_waitNode; // its own, to wait for a single ConditionVariable
 	Mutex* m_mutex = nullptr;
+	InheritanceMutex* m_heldMutexes = nullptr;
+	InheritanceMutex* m_blockedOn = nullptr;
+	std::optional<uint32_t> m_returnValue;
+	CpuAccount m_cpu;
+	duration m_budget = duration(0);
+	duration m_budgetPeriod = duration(0);
+	time_point m_replenishAt = Startup; // end of the current budget period
+	uint64_t m_budgetStart = 0; // m_cpu cycles when the current budget period started
+	mutable StackWatermark m_watermark;
 
 	static constexpr uint32_t kFpFlag = 0b10000; // if this bit is NOT set in LR at exception, then the stack frame and saved context both use floating point context
 
 	static void taskStarter(TaskControlBlock* thisPtr);
 
+	/**
+	 * @brief Sets the value returned by the service call the @c TaskControlBlock is waiting in
+	 * @param value The value to return
+	 * @remark It is only written to the stack frame when the @c TaskControlBlock is resumed, an interrupt service routine may wake it up before its context is saved
+	 */
 	void setReturnValue(uint32_t value)
 	{
+		m_returnValue = value;
+	}
+
+	void applyReturnValue()
+	{
+		const uint32_t value = m_returnValue.value();
+		m_returnValue = std::nullopt;
+
+#if defined(OPSY_POSIX)
+		Context* context = reinterpret_cast<Context*>(m_stackPointer);
+		assert(context->frame != nullptr); // the task is not suspended in a service call
+		context->frame->r0 = value;
+#else
 		auto ptr = m_stackPointer;
 		Context* context = reinterpret_cast<Context*>(ptr);
 
@@ -317,6 +554,7 @@ private:
 		StackFrame* frame = reinterpret_cast<StackFrame*>(ptr); // we are at the top of the frame stacked by cortex on exception entry
 
 		frame->r0 = value;
+#endif
 	}
 };
 
@@ -366,9 +604,21 @@ public:
 	 * @param stackSize The size of the stack, in @c StackItem increment
 	 * @param entry The @c CodePointer to the idle code
 	 */
+#if defined(OPSY_POSIX)
 	IdleTaskControlBlock(uint32_t* stackBase, std::size_t stackSize, const CodePointer entry) :
-			m_stackPointer(&stackBase[stackSize])
+			m_stackBase(stackBase), m_stackSize(stackSize), m_stackPointer(CortexM::prepareStack(stackBase, [](void* code)
+			{
+				reinterpret_cast<CodePointer>(code)();
+			}, reinterpret_cast<void*>(entry)))
 	{
+	}
+#else
+	IdleTaskControlBlock(uint32_t* stackBase, std::size_t stackSize, const CodePointer entry) :
+			m_stackBase(stackBase), m_stackSize(stackSize), m_stackPointer(&stackBase[stackSize])
+	{
+		if constexpr (kPaintStacks)
+			m_watermark.paint(stackBase, stackSize);
+
 		m_stackPointer -= sizeof(StackFrame) / sizeof(uint32_t);
 		const auto frame = reinterpret_cast<StackFrame*>(m_stackPointer);
 
@@ -382,17 +632,39 @@ public:
 		context->lr = 0xFFFFFFFD;
 		context->control = 0b10;
 	}
+#endif
+
+	/**
+	 * @brief Gets a snapshot of the processor time used by the idle task
+	 * @return The processor time used, all zeros if @c kCpuAccounting is disabled
+	 * @remark Depending on the device, the cycle counter may stop while the core sleeps in @c WFI, the load of the @c Task is then still correct but the idle one is lower than expected
+	 */
+	CpuUsage cpuUsage() const;
+
+	/**
+	 * @brief Measures the deepest use of the idle task stack so far
+	 * @param scan @c true to scan the stack now, @c false to get the mark as of the last scan (e.g. by @c Scheduler::scanStacks)
+	 * @return The number of @c uint32_t used at most, @c 0 if stacks are not painted (see @c kStackPainting)
+	 * @remark On the POSIX port the idle task runs on a host stack, this is always @c 0
+	 */
+	std::size_t stackHighWaterMark(bool scan = true) const;
 
 private:
 
+	uint32_t* const m_stackBase;
+	const std::size_t m_stackSize;
 	uint32_t* m_stackPointer;
+	CpuAccount m_cpu;
+	mutable StackWatermark m_watermark;
 
+#if !defined(OPSY_POSIX)
 	static void __attribute__((naked)) noReturn()
 	{
 		asm volatile(
 				"nop \n\t"
 				"bkpt 0");
 	}
+#endif
 };
 
 /**
@@ -430,7 +702,7 @@ IdleTask<StackSize> DefaultIdle = IdleTask<StackSize>([]()
 {
 	while(true)
 	{
-#ifndef NDEBUG
+#if !defined(NDEBUG) && !defined(OPSY_POSIX) // the POSIX port always sleeps, a spinning idle would freeze virtual time
 		CortexM::nop();
 #else
 		CortexM::wfi();
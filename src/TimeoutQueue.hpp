@@ -0,0 +1,341 @@
+/**
+ ******************************************************************************
+ * @file    TimeoutQueue.hpp
+ * @author  Thomas Legrand
+ * @version V0.1
+ * @date    16-October-2026
+ * @brief   Containers for items waiting for a timeout
+ *
+ * 			The containers used by the @c Scheduler to hold items waiting for
+ * 			a timeout, ordered by their @c m_waitUntil @c time_point.
+ *
+ * 			@c SortedTimeoutQueue keeps a single sorted list, it is small but
+ * 			each insertion walks the list.
+ *
+ * 			@c TimeoutWheel is a hierarchical timing wheel: each level has 32
+ * 			slots, level 0 slots are one tick wide, and each level is 32 times
+ * 			coarser than the previous one. Items are cascaded to lower levels
+ * 			when their slot comes up. Insertion and cancellation are constant
+ * 			time, and each tick only touches the slots that come up.
+ *
+ * 			The implementation used is selected with @c kTimeoutWheel
+ *
+ ******************************************************************************
+ * @copyright Copyright 2019 Thomas Legrand under the MIT License
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************
+ * @see https://github.com/Otatiaro/OpSy
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cassert>
+#include <optional>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+#include "Config.hpp"
+#include "EmbeddedList.hpp"
+#include "CortexM.hpp"
+
+namespace opsy
+{
+
+/**
+ * @brief A timeout queue that keeps all items in a single list sorted by their @c m_waitUntil
+ * @tparam Item The item type, it must have an @c std::optional<time_point> @c m_waitUntil member
+ * @tparam Interface The @c EmbeddedNode interface used to link items
+ */
+template<typename Item, typename Interface>
+class SortedTimeoutQueue
+{
+public:
+
+	/**
+	 * @brief Checks if there is no item waiting for a timeout
+	 * @return @c true if there is no item waiting for a timeout, @c false otherwise
+	 */
+	inline bool empty() const
+	{
+		return m_list.empty();
+	}
+
+	/**
+	 * @brief Inserts an item, its @c m_waitUntil must be set
+	 * @param item The item to insert
+	 */
+	inline void insert(Item& item)
+	{
+		m_list.insertWhen(wakeupAfter, item);
+	}
+
+	/**
+	 * @brief Removes an item before its timeout
+	 * @param item The item to remove
+	 */
+	inline void erase(Item& item)
+	{
+		m_list.erase(item);
+	}
+
+	/**
+	 * @brief Removes and returns an item whose timeout is reached
+	 * @param now The current @c time_point
+	 * @return An item whose @c m_waitUntil is before or at @p now, or @c nullptr if there is none
+	 * @remark Call it in a loop to get all expired items
+	 */
+	inline Item* expired(time_point now)
+	{
+		if (m_list.empty() || m_list.front().m_waitUntil.value() > now)
+			return nullptr;
+
+		auto& item = m_list.front();
+		m_list.pop_front();
+		return &item;
+	}
+
+	/**
+	 * @brief Gets the @c time_point of the next timeout
+	 * @return The @c time_point of the next timeout, or @c std::nullopt if there is no item
+	 */
+	inline std::optional<time_point> nextDeadline()
+	{
+		if (m_list.empty())
+			return std::nullopt;
+		return m_list.front().m_waitUntil;
+	}
+
+private:
+
+	EmbeddedList<Item, Interface> m_list;
+
+	static constexpr bool wakeupAfter(const Item& left, const Item& right)
+	{
+		assert(left.m_waitUntil.has_value() && right.m_waitUntil.has_value());
+		return left.m_waitUntil.value_or(Startup) < right.m_waitUntil.value_or(Startup);
+	}
+};
+
+/**
+ * @brief A hierarchical timing wheel
+ * @tparam Item The item type, it must have an @c std::optional<time_point> @c m_waitUntil member and an @c uint8_t @c m_timeoutSlot member
+ * @tparam Interface The @c EmbeddedNode interface used to link items
+ * @tparam Levels The number of levels, the wheel covers @c 32^Levels ticks, items further in time are cascaded again when the last level comes up
+ * @remark The wheel has its own cursor, which is advanced by @c expired, items are placed relatively to this cursor
+ */
+template<typename Item, typename Interface, std::size_t Levels = 4>
+class TimeoutWheel
+{
+	static constexpr std::size_t kSlotBits = 5;
+	static constexpr std::size_t kSlots = 1 << kSlotBits;
+	static constexpr uint32_t kSlotMask = kSlots - 1;
+
+	static_assert(Levels >= 1 && kSlotBits * Levels < 31, "Timeout wheel levels must cover less than 2^31 ticks");
+	static_assert(Levels * kSlots <= 256, "Timeout wheel slots must be indexed by an uint8_t");
+
+	static constexpr int32_t kMaxDelta = (1 << (kSlotBits * Levels)) - 1;
+
+public:
+
+	/**
+	 * @brief Checks if there is no item waiting for a timeout
+	 * @return @c true if there is no item waiting for a timeout, @c false otherwise
+	 */
+	inline bool empty() const
+	{
+		return m_size == 0;
+	}
+
+	/**
+	 * @brief Inserts an item, its @c m_waitUntil must be set
+	 * @param item The item to insert
+	 * @remark An item whose @c m_waitUntil is already reached expires on the next tick
+	 */
+	inline void insert(Item& item)
+	{
+		place(item, 1);
+		++m_size;
+	}
+
+	/**
+	 * @brief Removes an item before its timeout
+	 * @param item The item to remove
+	 */
+	inline void erase(Item& item)
+	{
+		auto& slot = m_slots[item.m_timeoutSlot / kSlots][item.m_timeoutSlot % kSlots];
+		slot.erase(item);
+		if (slot.empty())
+			m_occupied[item.m_timeoutSlot / kSlots] &= ~(1u << (item.m_timeoutSlot % kSlots));
+		--m_size;
+	}
+
+	/**
+	 * @brief Advances the wheel up to @p now, then removes and returns an item whose timeout is reached
+	 * @param now The current @c time_point
+	 * @return An item whose @c m_waitUntil is before or at @p now, or @c nullptr if there is none
+	 * @remark Call it in a loop to get all expired items
+	 * @remark The cursor jumps from one occupied slot to the next, the cost depends on the slots it goes past, not on the number of ticks elapsed since the last call
+	 */
+	Item* expired(time_point now)
+	{
+		while (true)
+		{
+			if (m_size == 0) // nothing to cascade, jump directly
+			{
+				m_cursor = std::max(m_cursor, now);
+				return nullptr;
+			}
+
+			const auto index = cursor() & kSlotMask;
+			auto& slot = m_slots[0][index];
+
+			if (!slot.empty()) // the current level 0 slot only contains items due on the cursor
+			{
+				auto& item = slot.front();
+				slot.pop_front();
+				if (slot.empty())
+					m_occupied[0] &= ~(1u << index);
+				--m_size;
+				return &item;
+			}
+
+			if (m_cursor >= now)
+				return nullptr;
+
+			const auto elapsed = static_cast<uint32_t>((now - m_cursor).count());
+			m_cursor += duration(static_cast<int32_t>(std::min(distance(), elapsed) - 1)); // no slot comes up in between
+			tick();
+		}
+	}
+
+	/**
+	 * @brief Gets a lower bound of the @c time_point of the next timeout
+	 * @return The @c time_point of the next timeout, or of the next cascade of a higher level, or @c std::nullopt if there is no item
+	 */
+	std::optional<time_point> nextDeadline() const
+	{
+		if (m_size == 0)
+			return std::nullopt;
+
+		return m_cursor + duration(static_cast<int32_t>(distance()));
+	}
+
+private:
+
+	std::array<std::array<EmbeddedList<Item, Interface>, kSlots>, Levels> m_slots;
+	std::array<uint32_t, Levels> m_occupied { }; // bit i set when slot i of the level is not empty
+	time_point m_cursor = Startup;
+	uint32_t m_size = 0;
+
+	inline uint32_t cursor() const
+	{
+		return static_cast<uint32_t>(m_cursor.time_since_epoch().count());
+	}
+
+	static constexpr inline uint32_t rotate(uint32_t value, uint32_t count)
+	{
+		return count == 0 ? value : (value >> count) | (value << (32 - count));
+	}
+
+	/**
+	 * @brief Gets the number of ticks from the cursor to the next occupied slot coming up, of any level
+	 * @return @c 0 if the current level 0 slot is occupied, the number of ticks to the next level 0 slot due or higher level slot to cascade otherwise
+	 * @warning The wheel must not be empty
+	 */
+	uint32_t distance() const
+	{
+		const uint32_t now = cursor();
+
+		if ((m_occupied[0] & (1u << (now & kSlotMask))) != 0)
+			return 0;
+
+		uint32_t best = std::numeric_limits<uint32_t>::max();
+
+		for (std::size_t level = 0; level < Levels; ++level)
+		{
+			if (m_occupied[level] == 0)
+				continue;
+
+			const auto shift = kSlotBits * level;
+			const uint32_t block = now >> shift;
+			const uint32_t distance = CortexM::countTrailingZeros(rotate(m_occupied[level], (block + 1) & kSlotMask)) + 1u; // in slots of this level, the slot of the current block is the farthest
+			best = std::min(best, ((block + distance) << shift) - now);
+		}
+
+		return best;
+	}
+
+	void place(Item& item, int32_t minimumDelta)
+	{
+		const int32_t delta = std::clamp((item.m_waitUntil.value() - m_cursor).count(), minimumDelta, kMaxDelta);
+		const uint32_t when = cursor() + static_cast<uint32_t>(delta);
+
+		std::size_t level = 0;
+		while (delta >= (1 << (kSlotBits * (level + 1))))
+			++level;
+
+		const auto index = (when >> (kSlotBits * level)) & kSlotMask;
+		m_slots[level][index].push_front(item);
+		m_occupied[level] |= 1u << index;
+		item.m_timeoutSlot = static_cast<uint8_t>(level * kSlots + index);
+	}
+
+	void tick()
+	{
+		m_cursor += duration(1);
+		const uint32_t now = cursor();
+
+		for (std::size_t level = Levels - 1; level > 0; --level) // cascade higher levels first, so items can go down several levels at once
+		{
+			const auto shift = kSlotBits * level;
+			if ((now & ((1u << shift) - 1)) != 0)
+				continue;
+
+			const auto index = (now >> shift) & kSlotMask;
+			auto& slot = m_slots[level][index];
+			m_occupied[level] &= ~(1u << index);
+
+			while (!slot.empty())
+			{
+				auto& item = slot.front();
+				slot.pop_front();
+				place(item, 0); // items due now go to the current level 0 slot
+			}
+		}
+	}
+};
+
+/**
+ * @brief The timeout queue implementation used by the @c Scheduler, selected with @c kTimeoutWheel
+ * @tparam Item The item type
+ * @tparam Interface The @c EmbeddedNode interface used to link items
+ */
+template<typename Item, typename Interface>
+using TimeoutQueue = std::conditional_t<kTimeoutWheel, TimeoutWheel<Item, Interface>, SortedTimeoutQueue<Item, Interface>>;
+
+}
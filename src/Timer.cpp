@@ -0,0 +1,117 @@
+#include <mutex>
+#include <cassert>
+
+#include "Timer.hpp"
+#include "Scheduler.hpp"
+
+namespace opsy
+{
+
+bool TimerService::start(TaskControlBlock& task, const char* name)
+{
+	{
+		std::lock_guard<Mutex> lock(m_guard);
+		if (m_task != nullptr) // already running in a Task
+			return false;
+		m_task = &task;
+	}
+
+	if (task.start([this]() { run(); }, name))
+		return true;
+
+	std::lock_guard<Mutex> lock(m_guard);
+	m_task = nullptr;
+	return false;
+}
+
+void TimerService::run()
+{
+	std::unique_lock<Mutex> lock(m_guard);
+
+	while (true)
+	{
+		m_wakeUp = time_point::min(); // the deadline is computed again below, no need to be notified
+		const auto now = Scheduler::now();
+
+		while (auto timer = m_timers.expired(now))
+		{
+			if (timer->m_mode == Timer::Mode::Periodic) // stays on the grid of its first expiry, missed periods are skipped
+			{
+				auto expiry = timer->m_waitUntil.value() + timer->m_period;
+				if (expiry <= now)
+					expiry += ((now - expiry) / timer->m_period + 1) * timer->m_period;
+				timer->m_waitUntil = expiry;
+				m_timers.insert(*timer);
+			}
+			else
+				timer->m_waitUntil.reset();
+
+			lock.unlock(); // the handler may start, reset or stop any timer, including its own
+			timer->m_handler();
+			lock.lock();
+		}
+
+		const auto next = m_timers.nextDeadline();
+		m_wakeUp = next.value_or(time_point::max());
+		lock.unlock();
+
+		if (next.has_value()) // a timer started in between notifies, the wait then returns right away
+			Scheduler::waitNotificationUntil(next.value());
+		else
+			Scheduler::waitNotification();
+
+		lock.lock();
+	}
+}
+
+time_point TimerService::now()
+{
+	return Scheduler::isStarted() ? Scheduler::now() : Startup; // the time starts with the Scheduler
+}
+
+void TimerService::schedule(Timer& timer, time_point expiry)
+{
+	timer.m_waitUntil = expiry;
+	m_timers.insert(timer);
+
+	if (expiry < m_wakeUp) // the Task sleeps past this expiry, wake it up to compute its deadline again
+	{
+		m_wakeUp = expiry;
+		m_task->notify(NotifyAction::SetBits, 1);
+	}
+}
+
+bool Timer::start()
+{
+	std::lock_guard<Mutex> lock(m_service.m_guard);
+	if (m_waitUntil.has_value())
+		return false;
+	m_service.schedule(*this, TimerService::now() + m_period);
+	return true;
+}
+
+void Timer::reset()
+{
+	std::lock_guard<Mutex> lock(m_service.m_guard);
+	if (m_waitUntil.has_value())
+		m_service.m_timers.erase(*this);
+	m_service.schedule(*this, TimerService::now() + m_period);
+}
+
+bool Timer::stop()
+{
+	std::lock_guard<Mutex> lock(m_service.m_guard);
+	if (!m_waitUntil.has_value())
+		return false;
+	m_service.m_timers.erase(*this);
+	m_waitUntil.reset();
+	return true;
+}
+
+bool Timer::running() const
+{
+	std::lock_guard<Mutex> lock(m_service.m_guard);
+	return m_waitUntil.has_value();
+}
+
+}
@@ -0,0 +1,214 @@
+/**
+ ******************************************************************************
+ * @file    Timer.hpp
+ * @author  Thomas Legrand
+ * @version V0.1
+ * @date    16-October-2026
+ * @brief   One-shot and periodic software timers
+ *
+ * 			This file contains the @c Timer class, that calls a handler once or
+ * 			periodically, and the @c TimerService class, that runs the handlers of
+ * 			its @c Timer in a single @c Task, so small periodic jobs do not each
+ * 			need their own @c Task and stack.
+ *
+ * 			The @c TimerService keeps its @c Timer in a @c TimeoutQueue, the
+ * 			container the @c Scheduler uses for its timeouts (a sorted list, or a
+ * 			timing wheel with @c kTimeoutWheel), and sleeps up to the first
+ * 			expiry. Nothing is allocated, and stopping a @c Timer is constant time.
+ *
+ ******************************************************************************
+ * @copyright Copyright 2019 Thomas Legrand under the MIT License
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************
+ * @see https://github.com/Otatiaro/OpSy
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <optional>
+
+#include "Config.hpp"
+#include "Callback.hpp"
+#include "EmbeddedList.hpp"
+#include "TimeoutQueue.hpp"
+#include "Task.hpp"
+
+namespace opsy
+{
+
+class TimerService;
+
+/**
+ * @brief Calls a handler when it expires, once or periodically, from the @c Task of its @c TimerService
+ * @remark @c start, @c reset and @c stop can be called from a @c Task, a handler or an interrupt service routine at or below @c TimerService::kPriority
+ */
+class Timer: private EmbeddedNode<Timer>
+{
+	template<typename T, typename I>
+	friend class EmbeddedIterator;
+	template<typename T, typename I>
+	friend class EmbeddedConstIterator;
+	template<typename I, typename If>
+	friend class SortedTimeoutQueue;
+	template<typename I, typename If, std::size_t L>
+	friend class TimeoutWheel;
+	friend class TimerService;
+
+public:
+
+	/**
+	 * @brief What a @c Timer does once it expired
+	 */
+	enum class Mode
+		: uint8_t
+		{
+			OneShot, ///< It stops, until it is started again
+		Periodic, ///< It expires again one period later, on the grid of its first expiry
+	};
+
+	/**
+	 * @brief Creates a stopped @c Timer
+	 * @param service The @c TimerService that runs @p handler
+	 * @param period The time from @c start or @c reset to the expiry, then between two expiries for a @c Mode::Periodic @c Timer
+	 * @param mode What it does once it expired
+	 * @param handler The handler called on expiry
+	 */
+	Timer(TimerService& service, duration period, Mode mode, Callback<void(void)>&& handler) :
+			m_service(service), m_handler(std::move(handler)), m_period(period), m_mode(mode)
+	{
+		assert(mode == Mode::OneShot || period > duration::zero()); // a periodic timer would expire forever
+	}
+
+	Timer(const Timer&) = delete;
+	void operator=(const Timer&) = delete;
+
+	/**
+	 * @brief Starts the @c Timer, it expires one period from now
+	 * @return @c true if it started, @c false if it was already running (it is left as is)
+	 * @remark Before the @c Scheduler starts, the period counts from its start
+	 */
+	bool start();
+
+	/**
+	 * @brief Starts the @c Timer again, it expires one period from now whether it was running or not
+	 * @remark Calling it before each expiry makes a software watchdog
+	 * @remark Before the @c Scheduler starts, the period counts from its start
+	 */
+	void reset();
+
+	/**
+	 * @brief Stops the @c Timer, in constant time
+	 * @return @c true if it was running, @c false otherwise
+	 * @remark A handler already called completes
+	 */
+	bool stop();
+
+	/**
+	 * @brief Checks if the @c Timer is running
+	 * @return @c true if it is started and has not expired yet (or is @c Mode::Periodic), @c false otherwise
+	 */
+	bool running() const;
+
+	/**
+	 * @brief Gets the period
+	 * @return The time from @c start or @c reset to the expiry, then between two expiries
+	 */
+	constexpr duration period() const
+	{
+		return m_period;
+	}
+
+	/**
+	 * @brief Gets the mode
+	 * @return What it does once it expired
+	 */
+	constexpr Mode mode() const
+	{
+		return m_mode;
+	}
+
+private:
+
+	TimerService& m_service;
+	Callback<void(void)> m_handler;
+	const duration m_period;
+	const Mode m_mode;
+	uint8_t m_timeoutSlot = 0;
+	std::optional<time_point> m_waitUntil; // its expiry, std::nullopt while stopped
+};
+
+/**
+ * @brief Runs the handlers of its @c Timer, in the @c Task it is started with.
+ * The handlers run one after the other, at the @c Priority of this @c Task, so they must be short and must not block
+ * @remark A typical use:
+ * @code
+ * Task<512> s_timerTask;
+ * TimerService s_timers;
+ * Timer s_blink(s_timers, 250ms, Timer::Mode::Periodic, []() { toggleLed(); });
+ *
+ * s_timerTask.priority(Priority::High);
+ * s_timers.start(s_timerTask);
+ * s_blink.start(); // first expiry 250ms after Scheduler::start
+ * Scheduler::start();
+ * @endcode
+ */
+class TimerService
+{
+	friend class Timer;
+
+public:
+
+	/**
+	 * @brief The most important @c IsrPriority allowed to start or stop a @c Timer, the one of the @c Mutex protecting the @c TimerService, just below the @c Scheduler
+	 */
+	static constexpr auto kPriority = IsrPriority::FromPreemptSub<kPreemptionBits>(kOpsyPreemption + 1, 0);
+
+	constexpr TimerService() = default;
+
+	TimerService(const TimerService&) = delete;
+	void operator=(const TimerService&) = delete;
+
+	/**
+	 * @brief Starts the @c TimerService in @p task, which then only runs the handlers of its @c Timer
+	 * @param task The @c Task to run in, its stack must fit the largest handler
+	 * @param name The name of @p task
+	 * @return @c true if it started, @c false if the @c TimerService or @p task was already started
+	 */
+	bool start(TaskControlBlock& task, const char* name = "timers");
+
+private:
+
+	Mutex m_guard { kPriority };
+	TimeoutQueue<Timer, Timer> m_timers;
+	TaskControlBlock* m_task = nullptr;
+	time_point m_wakeUp = time_point::min(); // when the Task wakes up on its own, time_point::max() if it only waits for a notification, time_point::min() while it runs the handlers or is not started
+
+	void run();
+	void schedule(Timer& timer, time_point expiry);
+	static time_point now();
+};
+
+}
@@ -0,0 +1,228 @@
+/**
+ ******************************************************************************
+ * @file    WaitSet.hpp
+ * @author  Thomas Legrand
+ * @version V0.1
+ * @date    16-October-2026
+ * @brief   Wait for any of several kernel objects
+ *
+ * 			This file contains the @c WaitSet class template, that makes a @c Task
+ * 			wait for any of several kernel objects at once (@c ConditionVariable,
+ * 			@c MessageQueue to receive from or send to) and tells it which one
+ * 			ended the wait.
+ *
+ * 			The @c Task waits in the waiting list of every member at the same
+ * 			time, through one @c WaitNode per member, and leaves all of them when
+ * 			the first one fires or the wait times out.
+ *
+ ******************************************************************************
+ * @copyright Copyright 2019 Thomas Legrand under the MIT License
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************
+ * @see https://github.com/Otatiaro/OpSy
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+
+#include "Config.hpp"
+#include "Callback.hpp"
+#include "ConditionVariable.hpp"
+#include "MessageQueue.hpp"
+#include "Scheduler.hpp"
+
+namespace opsy
+{
+
+/**
+ * @brief Waits for any of up to @p Size kernel objects, the members.
+ * A @c ConditionVariable member fires when it is notified, a @c MessageQueue member when a message is received from it (or sent to it)
+ * @tparam Size The maximum number of members
+ * @remark Before waiting, the members are checked with every @c Task and interrupt service routine allowed to use OpSy masked: a @c MessageQueue
+ * 			member with a message (or room) is served right away, as is a @c ConditionVariable member whose @c ready function returns @c true, so nothing is missed between the check and the wait
+ * @warning A @c WaitSet is used by a single @c Task, which must not change its members while it waits
+ */
+template<std::size_t Size>
+class WaitSet
+{
+	static_assert(Size > 0, "WaitSet size cannot be 0");
+
+public:
+
+	/**
+	 * @brief The @c IsrPriority of the @c Mutex that masks the members while they are checked, just below the @c Scheduler
+	 */
+	static constexpr auto kPriority = IsrPriority::FromPreemptSub<kPreemptionBits>(kOpsyPreemption + 1, 0);
+
+	constexpr WaitSet() = default;
+
+	WaitSet(const WaitSet&) = delete;
+	void operator=(const WaitSet&) = delete;
+
+	/**
+	 * @brief Adds a @c ConditionVariable member, that fires when it is notified
+	 * @param condition The @c ConditionVariable
+	 * @return The index of the member, returned by the wait it ends
+	 * @remark A notification that comes while the @c Task does not wait is lost, as with @c ConditionVariable::wait without @c Mutex
+	 */
+	std::size_t add(ConditionVariable& condition)
+	{
+		return insert(condition, { }, nullptr);
+	}
+
+	/**
+	 * @brief Adds a @c ConditionVariable member along with the state it signals
+	 * @param condition The @c ConditionVariable
+	 * @param ready Called before waiting, it returns @c true if the state is already signaled, the member then fires right away
+	 * @return The index of the member, returned by the wait it ends
+	 * @remark The notifier changes the state before it notifies @p condition, so a notification is either seen by @p ready or ends the wait
+	 */
+	template<typename Ready>
+	std::size_t add(ConditionVariable& condition, Ready&& ready)
+	{
+		return insert(condition, std::forward<Ready>(ready), nullptr);
+	}
+
+	/**
+	 * @brief Adds a @c MessageQueue member, that fires when a message is received from it
+	 * @param queue The @c MessageQueue
+	 * @param message Receives the message, it must live as long as the member
+	 * @return The index of the member, returned by the wait it ends
+	 */
+	template<typename T, std::size_t Capacity>
+	std::size_t addReceive(MessageQueue<T, Capacity>& queue, T& message)
+	{
+		return insert(queue.m_receivers, [&queue, &message]() { return queue.take(message); }, &message);
+	}
+
+	/**
+	 * @brief Adds a @c MessageQueue member, that fires when a message is sent to it
+	 * @param queue The @c MessageQueue
+	 * @param message The message to send, it must live as long as the member (it is moved from once sent)
+	 * @return The index of the member, returned by the wait it ends
+	 */
+	template<typename T, std::size_t Capacity>
+	std::size_t addSend(MessageQueue<T, Capacity>& queue, T& message)
+	{
+		return insert(queue.m_senders, [&queue, &message]() { return queue.give(message); }, &message);
+	}
+
+	/**
+	 * @brief Gets the number of members
+	 * @return The number of members
+	 */
+	std::size_t size() const
+	{
+		return m_size;
+	}
+
+	/**
+	 * @brief Waits, as long as needed, for a member to fire
+	 * @return The index of the member that fired
+	 * @warning This should only be called from @c Task
+	 */
+	std::size_t wait()
+	{
+		const auto fired = wait(std::nullopt);
+		assert(fired.has_value()); // without time limit, the wait only ends when a member fires
+		return fired.value_or(0);
+	}
+
+	/**
+	 * @brief Waits at most @p timeout for a member to fire
+	 * @param timeout The time limit of the wait
+	 * @return The index of the member that fired, or nothing if @p timeout elapsed first
+	 * @warning This should only be called from @c Task
+	 */
+	std::optional<std::size_t> wait_for(duration timeout)
+	{
+		return wait(Scheduler::now() + timeout);
+	}
+
+	/**
+	 * @brief Waits at most up to @p timeout_time for a member to fire
+	 * @param timeout_time The time limit of the wait
+	 * @return The index of the member that fired, or nothing if @p timeout_time was reached first
+	 * @warning This should only be called from @c Task
+	 */
+	std::optional<std::size_t> wait_until(time_point timeout_time)
+	{
+		return wait(timeout_time);
+	}
+
+private:
+
+	Mutex m_guard { kPriority }; // masks every Task and interrupt service routine that can fire a member, between the check and the wait
+	std::array<WaitNode, Size> m_nodes; // chained in the order of the members
+	std::array<Callback<bool(void)>, Size> m_ready; // checks if a member fires without waiting, takes or gives its message
+	std::size_t m_size = 0;
+
+	std::size_t insert(ConditionVariable& condition, Callback<bool(void)>&& ready, void* message)
+	{
+		assert(m_size < Size); // no room for another member
+		auto& node = m_nodes[m_size];
+		node.m_condition = &condition;
+		node.m_message = message;
+		if (m_size != 0)
+			m_nodes[m_size - 1].m_nextInWait = &node;
+		m_ready[m_size] = std::move(ready);
+		return m_size++;
+	}
+
+	std::optional<std::size_t> wait(std::optional<time_point> timeout_time)
+	{
+		assert(CortexM::ipsr() == 0); // cannot wait in interrupt
+		assert(m_size != 0); // nothing to wait for
+
+		std::unique_lock<Mutex> guard(m_guard);
+
+		for (auto i = 0u; i < m_size; ++i)
+			if (m_ready[i]().value_or(false)) // fires without waiting, a plain ConditionVariable member never does
+				return i;
+
+		if (timeout_time.has_value() && timeout_time.value() <= Scheduler::now())
+			return std::nullopt;
+
+		const auto timeout = timeout_time.has_value() ? (timeout_time.value() - Scheduler::now()).count() : -1;
+		const auto result = Scheduler::serviceCall<Scheduler::ServiceCallNumber::WaitAny>(reinterpret_cast<uintptr_t>(&m_nodes[0]), static_cast<uintptr_t>(timeout),
+				reinterpret_cast<uintptr_t>(&m_guard));
+
+		if (static_cast<std::cv_status>(result) == std::cv_status::timeout)
+			return std::nullopt;
+
+		for (auto i = 0u; i < m_size; ++i)
+			if (m_nodes[i].m_fired) // set by the member that released it
+				return i;
+
+		assert(false); // released with no timeout, a member fired
+		return std::nullopt;
+	}
+};
+
+}
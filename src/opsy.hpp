@@ -43,7 +43,18 @@
 #include "Task.hpp"
 #include "Scheduler.hpp"
 #include "PriorityMutex.hpp"
+#include "InheritanceMutex.hpp"
+#include "CeilingMutex.hpp"
 #include "ConditionVariable.hpp"
+#include "Periodic.hpp"
+#include "ScheduleTable.hpp"
+#include "Semaphore.hpp"
+#include "EventGroup.hpp"
+#include "SpscRing.hpp"
+#include "MessageQueue.hpp"
+#include "MemoryPool.hpp"
+#include "WaitSet.hpp"
+#include "Timer.hpp"
 
 namespace opsy
 {
@@ -55,24 +66,20 @@ namespace opsy
  */
 void inline sleep_for(duration t)
 {
-	asm volatile(
-			"mov r0, %[count] \n\t"
-			"svc %[immediate]"
-			:
-			: [immediate] "I" (Scheduler::ServiceCallNumber::Sleep), [count] "r" (t.count())
-			: "r0");
+	Scheduler::serviceCall<Scheduler::ServiceCallNumber::Sleep>(static_cast<uintptr_t>(t.count()));
 }
 
 /**
  * @brief Puts the @c Task to sleep up to a @c time_point
+ * @remark The @c time_point is given to the @c Scheduler as is, the @c Task wakes up on the tick of @p tp (there is no extra tick as with @c sleep_for), or returns right away if @p tp has passed
  * @warning This should only be called from @c Task and never from interrupt service routine
- * @warning Make sure you release all @c Mutex before you call @c sleep_for
+ * @warning Make sure you release all @c Mutex before you call @c sleep_until
  */
 void inline sleep_until(time_point tp)
 {
 	using namespace std::chrono_literals;
 	assert(tp-Scheduler::now() < 1h); // if you sleep for more than 1h you probably are missing something (low power mode)
-	sleep_for(tp - Scheduler::now());
+	Scheduler::serviceCall<Scheduler::ServiceCallNumber::SleepUntil>(static_cast<uintptr_t>(tp.time_since_epoch().count()));
 }
 
 }
@@ -0,0 +1,505 @@
+#include "../CortexM.hpp"
+
+#if defined(OPSY_POSIX)
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <ctime>
+
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+extern "C"
+{
+uint32_t __attribute__((weak)) SystemCoreClock = 100000000; // the simulated core runs at 100MHz, define it in the application to change it
+}
+
+namespace opsy
+{
+
+namespace
+{
+
+constexpr std::size_t kHostStackSize = 256 * 1024; // host code (libc, etc.) needs much more stack than the target
+constexpr std::size_t kMaxHostStacks = 128;
+
+struct HostStack
+{
+	uint32_t* stackBase; // the target stack this host stack replaces
+	void* memory;
+	ucontext_t machine;
+	CortexM::Context context;
+	void (*entry)(void*);
+	void* argument;
+};
+
+HostStack s_hostStacks[kMaxHostStacks]; // zero initialized, so it can be used by static constructors (e.g. idle task)
+
+struct
+{
+	bool enabled;
+	uint64_t start; // cycle at which the current period started
+	uint64_t length; // length of the current period, in cycles
+	uint32_t load; // the LOAD register, used for the next periods
+	uint32_t stoppedValue; // the VAL register while the counter is stopped
+} s_systick;
+
+uint64_t s_cycleOffset = 0;
+uint64_t s_virtualCycles = 0;
+uint64_t s_random = 0x9E3779B97F4A7C15u;
+
+uint64_t coreCycles()
+{
+	if constexpr (kVirtualTime)
+		return s_virtualCycles;
+
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	const auto nanoseconds = static_cast<unsigned __int128>(now.tv_sec) * 1000000000u + static_cast<unsigned __int128>(now.tv_nsec);
+	return static_cast<uint64_t>(nanoseconds * getCoreClock() / 1000000000u);
+}
+
+}
+
+CortexM::IsrHandler CortexM::s_vector[MaxIrq + 1 + kSystemIrqs] = {};
+CortexM::IsrHandler* CortexM::s_vtor = CortexM::s_vector;
+uint8_t CortexM::s_priorities[MaxIrq + 1 + kSystemIrqs] = {};
+volatile bool CortexM::s_pending[MaxIrq + 1 + kSystemIrqs] = {};
+bool CortexM::s_enabled[MaxIrq + 1] = {};
+volatile uint32_t CortexM::s_pendingCount = 0;
+uint16_t CortexM::s_active[MaxDepth] = {};
+volatile std::size_t CortexM::s_depth = 0;
+volatile uint8_t CortexM::s_basepri = 0;
+volatile bool CortexM::s_primask = false;
+uint8_t CortexM::s_preemptBits = kPrigroupMax + 1;
+const volatile void* CortexM::s_exclusive = nullptr;
+volatile uint32_t CortexM::s_portLock = 0;
+volatile bool CortexM::s_deferred = false;
+CortexM::StackFrame* CortexM::s_serviceFrame = nullptr;
+uint8_t CortexM::s_serviceNumber = 0;
+bool CortexM::s_serviceFromThread = false;
+uint32_t* CortexM::s_msp = nullptr;
+uint32_t* CortexM::s_psp = nullptr;
+uint32_t CortexM::s_control = 0;
+
+void CortexM::exitPort()
+{
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+	s_portLock = s_portLock - 1;
+
+	if (s_portLock == 0 && s_deferred) // a Systick signal arrived while the port was locked, handle it now
+	{
+		s_deferred = false;
+		tick();
+	}
+}
+
+void CortexM::markPending(std::size_t exception)
+{
+	if (!s_pending[exception])
+	{
+		s_pending[exception] = true;
+		s_pendingCount = s_pendingCount + 1;
+	}
+}
+
+int CortexM::selectPending()
+{
+	if (s_pendingCount == 0)
+		return -1;
+
+	const uint8_t groupMask = static_cast<uint8_t>(0xFF00u >> s_preemptBits); // only the preemption priority matters for preemption
+	unsigned int threshold = 0x100; // thread mode, anything can preempt
+
+	if (s_depth != 0)
+		threshold = s_priorities[s_active[s_depth - 1]] & groupMask;
+	if (s_basepri != 0)
+		threshold = std::min(threshold, static_cast<unsigned int>(s_basepri & groupMask));
+	if (s_primask)
+		threshold = 0;
+
+	int best = -1;
+	unsigned int bestPriority = 0x100;
+
+	for (std::size_t exception = static_cast<std::size_t>(SystemIrq::NonMaskableInterrupt); exception < MaxIrq + 1 + kSystemIrqs; ++exception)
+		if (s_pending[exception] && (exception < kSystemIrqs || s_enabled[exception - kSystemIrqs]) && s_priorities[exception] < bestPriority)
+		{
+			best = static_cast<int>(exception);
+			bestPriority = s_priorities[exception];
+		}
+
+	if (best >= 0 && (bestPriority & groupMask) < threshold)
+		return best;
+	else
+		return -1;
+}
+
+void CortexM::take(std::size_t exception)
+{
+	s_pending[exception] = false;
+	s_pendingCount = s_pendingCount - 1;
+	assert(s_depth < MaxDepth);
+	s_active[s_depth] = static_cast<uint16_t>(exception);
+	s_depth = s_depth + 1;
+	s_exclusive = nullptr; // exception entry clears the exclusive monitor
+	exitPort();
+
+	assert(s_vtor[exception] != nullptr); // no handler for this interrupt
+	s_vtor[exception]();
+
+	enterPort();
+	s_depth = s_depth - 1;
+	s_exclusive = nullptr; // and so does exception return
+}
+
+void CortexM::dispatch()
+{
+	enterPort();
+	for (auto exception = selectPending(); exception >= 0; exception = selectPending())
+		take(static_cast<std::size_t>(exception));
+	exitPort();
+}
+
+void CortexM::setPendingException(std::size_t exception)
+{
+	enterPort();
+	markPending(exception);
+	exitPort();
+	dispatch();
+}
+
+void CortexM::clearPendingException(std::size_t exception)
+{
+	enterPort();
+	if (s_pending[exception])
+	{
+		s_pending[exception] = false;
+		s_pendingCount = s_pendingCount - 1;
+	}
+	exitPort();
+}
+
+void CortexM::serviceCall(uint8_t number, StackFrame& frame)
+{
+	enterPort();
+	assert(s_serviceFrame == nullptr);
+	s_serviceFrame = &frame;
+	s_serviceNumber = number;
+	s_serviceFromThread = s_depth == 0;
+	markPending(static_cast<std::size_t>(SystemIrq::ServiceCall));
+	exitPort();
+
+	dispatch();
+
+	assert(!s_pending[static_cast<std::size_t>(SystemIrq::ServiceCall)]); // the service call was masked, this is a hard fault on the target
+	s_serviceFrame = nullptr;
+}
+
+uint64_t CortexM::updateSystick()
+{
+	const auto now = coreCycles();
+
+	while (s_systick.enabled && now - s_systick.start >= s_systick.length) // the counter reached zero, it reloads and the interrupt is pending
+	{
+		s_systick.start += s_systick.length;
+		s_systick.length = s_systick.load + 1u;
+		markPending(static_cast<std::size_t>(SystemIrq::Systick));
+	}
+
+	return now;
+}
+
+void CortexM::armSystick()
+{
+	if constexpr (kVirtualTime) // no signal, the Systick interrupt is raised when the clock is advanced
+		return;
+
+	itimerval timer { };
+
+	if (s_systick.enabled)
+	{
+		const auto now = coreCycles();
+		const auto end = s_systick.start + s_systick.length;
+		const auto cycles = end > now ? end - now : 0;
+		const auto microseconds = std::max<uint64_t>(1, (static_cast<unsigned __int128>(cycles) * 1000000u + getCoreClock() - 1) / getCoreClock());
+		timer.it_value.tv_sec = static_cast<time_t>(microseconds / 1000000u);
+		timer.it_value.tv_usec = static_cast<suseconds_t>(microseconds % 1000000u);
+	}
+
+	setitimer(ITIMER_REAL, &timer, nullptr);
+}
+
+void CortexM::tick()
+{
+	enterPort();
+	updateSystick();
+	armSystick();
+	exitPort();
+	dispatch();
+}
+
+void CortexM::onAlarm(int)
+{
+	const auto savedErrno = errno;
+
+	if (s_portLock != 0) // the port state is being modified, defer
+		s_deferred = true;
+	else
+		tick();
+
+	errno = savedErrno;
+}
+
+void CortexM::enableSystick(uint32_t reload)
+{
+	assert(reload != 0);
+	assert(reload - 1 <= SystickReloadMask);
+
+	if (const char* value = std::getenv("OPSY_SEED"))
+		seed(std::strtoull(value, nullptr, 0));
+
+	if constexpr (!kVirtualTime)
+	{
+		struct sigaction action { };
+		action.sa_handler = onAlarm;
+		action.sa_flags = SA_RESTART;
+		sigemptyset(&action.sa_mask);
+		sigaction(SIGALRM, &action, nullptr);
+	}
+
+	restartSystick(reload, reload);
+}
+
+uint32_t CortexM::systickCount()
+{
+	return s_systick.load - systickValue();
+}
+
+uint32_t CortexM::systickValue()
+{
+	enterPort();
+	const auto now = updateSystick();
+	const auto value = s_systick.enabled ? static_cast<uint32_t>(s_systick.length - 1 - (now - s_systick.start)) : s_systick.stoppedValue;
+	exitPort();
+	return value;
+}
+
+void CortexM::stopSystick()
+{
+	enterPort();
+	const auto now = updateSystick();
+	if (s_systick.enabled)
+		s_systick.stoppedValue = static_cast<uint32_t>(s_systick.length - 1 - (now - s_systick.start));
+	s_systick.enabled = false;
+	armSystick();
+	exitPort();
+}
+
+void CortexM::resumeSystick()
+{
+	enterPort();
+	s_systick.start = coreCycles() - (s_systick.length - 1 - s_systick.stoppedValue);
+	s_systick.enabled = true;
+	armSystick();
+	exitPort();
+}
+
+void CortexM::restartSystick(uint32_t first, uint32_t reload)
+{
+	assert(first != 0 && reload != 0);
+	assert(first - 1 <= SystickReloadMask && reload - 1 <= SystickReloadMask);
+
+	enterPort();
+	s_systick.load = reload - 1;
+	s_systick.start = coreCycles();
+	s_systick.length = first;
+	s_systick.enabled = true;
+	armSystick();
+	exitPort();
+}
+
+bool CortexM::isSystickPending()
+{
+	enterPort();
+	updateSystick();
+	const bool result = s_pending[static_cast<std::size_t>(SystemIrq::Systick)];
+	exitPort();
+	return result;
+}
+
+void CortexM::enableInterrupt(uint32_t irq)
+{
+	assert(irq <= MaxIrq);
+	s_enabled[irq] = true;
+	dispatch();
+}
+
+void CortexM::disableInterrupt(uint32_t irq)
+{
+	assert(irq <= MaxIrq);
+	s_enabled[irq] = false;
+}
+
+void CortexM::setPending(uint32_t irq)
+{
+	assert(irq <= MaxIrq);
+	setPendingException(irq + kSystemIrqs);
+}
+
+void CortexM::clearPending(uint32_t irq)
+{
+	assert(irq <= MaxIrq);
+	clearPendingException(irq + kSystemIrqs);
+}
+
+bool CortexM::isActive(uint32_t irq)
+{
+	assert(irq <= MaxIrq);
+	return std::find(s_active, s_active + s_depth, irq + kSystemIrqs) != s_active + s_depth;
+}
+
+void CortexM::reset()
+{
+	std::exit(EXIT_SUCCESS);
+}
+
+void CortexM::wfi()
+{
+	if constexpr (kVirtualTime)
+	{
+		enterPort();
+		if (selectPending() < 0)
+		{
+			if (!s_systick.enabled) // nothing can ever wake up the core
+				std::abort();
+
+			s_virtualCycles = std::max(s_virtualCycles, s_systick.start + s_systick.length); // fast forward to the next Systick interrupt
+			updateSystick();
+		}
+		exitPort();
+		dispatch();
+	}
+	else
+	{
+		dispatch();
+		pause(); // any signal wakes up the process, its handler already ran when this returns
+	}
+}
+
+void CortexM::elapse(uint64_t cycles)
+{
+	if constexpr (kVirtualTime)
+	{
+		while (cycles != 0)
+		{
+			const auto step = s_systick.enabled ? std::min(cycles, s_systick.start + s_systick.length - s_virtualCycles) : cycles; // stop at the next Systick interrupt, it may preempt
+			s_virtualCycles += step;
+			cycles -= step;
+			enterPort();
+			updateSystick();
+			exitPort();
+			dispatch();
+		}
+	}
+	else
+	{
+		const auto end = coreCycles() + cycles;
+		while (coreCycles() < end)
+			nop();
+	}
+}
+
+void CortexM::seed(uint64_t value)
+{
+	s_random = value != 0 ? value : 0x9E3779B97F4A7C15u; // the generator state must not be zero
+}
+
+uint32_t CortexM::random()
+{
+	s_random ^= s_random >> 12; // xorshift64*
+	s_random ^= s_random << 25;
+	s_random ^= s_random >> 27;
+	return static_cast<uint32_t>((s_random * 0x2545F4914F6CDD1Du) >> 32);
+}
+
+uint32_t CortexM::cycleCount()
+{
+	return static_cast<uint32_t>(coreCycles() - s_cycleOffset);
+}
+
+void CortexM::cycleCount(uint32_t value)
+{
+	s_cycleOffset = coreCycles() - value;
+}
+
+uint32_t* CortexM::prepareStack(uint32_t* stackBase, void (*entry)(void*), void* argument)
+{
+	enterPort();
+
+	auto stack = std::find_if(std::begin(s_hostStacks), std::end(s_hostStacks), [stackBase](const HostStack& item) { return item.stackBase == stackBase; });
+
+	if (stack == std::end(s_hostStacks)) // first time this stack is used, allocate a host stack
+	{
+		stack = std::find_if(std::begin(s_hostStacks), std::end(s_hostStacks), [](const HostStack& item) { return item.stackBase == nullptr; });
+		assert(stack != std::end(s_hostStacks)); // too many stacks, increase kMaxHostStacks
+
+		stack->memory = mmap(nullptr, kHostStackSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK | MAP_NORESERVE, -1, 0);
+		assert(stack->memory != MAP_FAILED);
+		mprotect(stack->memory, static_cast<std::size_t>(sysconf(_SC_PAGESIZE)), PROT_NONE); // guard page, a host stack overflow faults instead of corrupting memory
+		stack->stackBase = stackBase;
+	}
+
+	stack->entry = entry;
+	stack->argument = argument;
+
+	getcontext(&stack->machine);
+	stack->machine.uc_stack.ss_sp = stack->memory;
+	stack->machine.uc_stack.ss_size = kHostStackSize;
+	stack->machine.uc_link = nullptr;
+	sigemptyset(&stack->machine.uc_sigmask); // the code may be prepared from a signal handler, but must start with signals enabled
+
+	const auto address = reinterpret_cast<uintptr_t>(&*stack);
+	makecontext(&stack->machine, reinterpret_cast<void (*)()>(trampoline), 2, static_cast<unsigned int>(address >> 32), static_cast<unsigned int>(address));
+	stack->context = Context { &stack->machine, nullptr };
+
+	exitPort();
+	return reinterpret_cast<uint32_t*>(&stack->context);
+}
+
+void CortexM::switchContext(SwitchResult (*handler)(uint32_t*))
+{
+	ucontext_t machine;
+	Context context { &machine, s_serviceFrame };
+	s_serviceFrame = nullptr;
+
+	const auto result = handler(reinterpret_cast<uint32_t*>(&context));
+	const auto next = reinterpret_cast<Context*>(result.stackPointer);
+
+	enterPort(); // a signal taken in the middle of swapcontext would run on the wrong stack, it is deferred to the resumed context
+	s_basepri = static_cast<uint8_t>(result.basepri);
+	if (next != &context)
+		swapcontext(&machine, next->machine);
+	exitPort();
+}
+
+void CortexM::trampoline(unsigned int high, unsigned int low)
+{
+	auto& stack = *reinterpret_cast<HostStack*>((static_cast<uintptr_t>(high) << 32) | low);
+
+	// we arrive here from switchContext in PendSV, do what its return and the exception return would do
+	s_depth = s_depth - 1;
+	s_exclusive = nullptr;
+	exitPort();
+	dispatch();
+
+	stack.entry(stack.argument);
+	assert(false); // code prepared by prepareStack never returns
+	std::abort();
+}
+
+}
+
+#endif
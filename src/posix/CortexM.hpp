@@ -0,0 +1,855 @@
+/**
+ ******************************************************************************
+ * @file    CortexM.hpp
+ * @author  Thomas Legrand
+ * @version V0.1
+ * @date    16-October-2026
+ * @brief   Cortex-M simulation for the POSIX (Linux host) port
+ *
+ * 			This is a drop-in replacement of the Cortex-M @c CortexM class that
+ * 			runs OpSy as a normal Linux process, so that applications can be run,
+ * 			debugged and benchmarked off-target.
+ *
+ * 			The processor is simulated: exceptions (Systick, PendSV, service call
+ * 			and peripheral interrupts) have their priorities, pending and active
+ * 			states, and are masked by simulated @c BASEPRI and @c PRIMASK exactly
+ * 			like on the target. Each @c Task runs on its own host stack, context
+ * 			switch is done with @c swapcontext, and the Systick is driven by
+ * 			@c SIGALRM, so tasks are preempted asynchronously like on the target.
+ *
+ * 			It is selected automatically when building for Linux, or by defining
+ * 			@c OPSY_POSIX.
+ *
+ * 			With @c kVirtualTime, the core clock is virtual: it only advances when
+ * 			the system is idle, jumping straight to the next Systick interrupt, or
+ * 			when code simulates its execution time with @c elapse. There is no
+ * 			signal involved, runs are deterministic and much faster than real time.
+ *
+ * 			@warning Tasks are preempted by a signal, do not call libc functions
+ * 			that take internal locks (@c malloc, @c printf, etc.) from several
+ * 			@c Task without protecting them with a @c Mutex
+ *
+ ******************************************************************************
+ * @copyright Copyright 2019 Thomas Legrand under the MIT License
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************
+ * @see https://github.com/Otatiaro/OpSy
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <atomic>
+
+#include <ucontext.h>
+
+#include "../Config.hpp"
+#include "../IsrPriority.hpp"
+
+namespace opsy
+{
+
+/**
+ * The maximum value of the @c PRIGROUP register
+ * @warning It is the maximum value, not the total number of values, with is this value + 1 (ending up at 8)
+ */
+static constexpr std::size_t kPrigroupMax = 7;
+
+/**
+ * @brief Simulates the Cortex-M low level features and system peripherals (NVIC, Systick, etc.) on a POSIX host
+ */
+class CortexM
+{
+public:
+
+	/**
+	 * @brief An Interrupt Service Routine (ISR) entry point definition, ISR are static or global methods with no return type and no arguments
+	 */
+	using IsrHandler = void(*)(void);
+
+	/**
+	 * @brief Number of system interrupt requests in the Cortex-M
+	 */
+	static constexpr uint32_t kSystemIrqs = 16;
+
+	/**
+	 * @brief Alignment of the SCB VTOR register. This alignment is MANDATORY to declare a RAM interrupt vector.
+	 */
+	static constexpr uint32_t kVtorAlignment = 0x200;
+
+	/**
+	 * @brief System interrupt requests
+	 */
+	enum class SystemIrq
+		: uint32_t
+		{
+			InitialSp = 0, ///< Value set to MSP at startup (it is not an IsrHandler but a memory pointer)
+		Reset = 1, ///< First code to be executed at system reset
+		NonMaskableInterrupt = 2, ///< Non maskable interrupt
+		HardFault = 3, ///< Hard Fault
+		ServiceCall = 11, ///< Service Call, used by OpSy for precise calls and automatic interrupt masking
+		PendSV = 14, ///< PendSV, used by OpSy for task switch
+		Systick = 15, ///< Systick, used by OpSy as main clock source
+	};
+
+	/**
+	 * @brief Cortex-M types
+	 * @remark The simulated processor always reports a Cortex-M4
+	 */
+	enum class Type
+		: uint16_t
+		{
+			M4 = 0xc24, ///< Cortex-M4
+		M7 = 0xc27, ///< Cortex-M7
+	};
+
+	/**
+	 * @brief Lowest priority available in the system
+	 * @remark Still an ISR priority, a task runs at no priority, so an ISR with this priority still preempts tasks
+	 */
+	static constexpr IsrPriority kLowestPriority = IsrPriority(0xFF);
+
+	/**
+	 * @brief Highest priority available in the system
+	 */
+	static constexpr IsrPriority kHighestPriority = IsrPriority(0);
+
+	/**
+	 * @brief The arguments and result of a service call, as seen by the service call handler
+	 */
+	struct StackFrame
+	{
+		uintptr_t r0;
+		uintptr_t r1;
+		uintptr_t r2;
+		uintptr_t r3;
+	};
+
+	/**
+	 * @brief The saved context of a suspended @c Task, its "stack pointer" points to it
+	 */
+	struct Context
+	{
+		ucontext_t* machine; ///< The host context to resume
+		StackFrame* frame; ///< The service call the @c Task is suspended in, if any
+	};
+
+	/**
+	 * @brief The result of a context switch: the context to restore and the @c BASEPRI value to restore
+	 */
+	struct SwitchResult
+	{
+		uint32_t* stackPointer;
+		uint32_t basepri;
+	};
+
+	/**
+	 * @brief Builds a @c SwitchResult
+	 * @param stackPointer The stack pointer (pointer to the @c Context) to restore
+	 * @param basepri The @c BASEPRI value to restore
+	 * @return The @c SwitchResult
+	 */
+	static inline SwitchResult switchResult(uint32_t* stackPointer, uint32_t basepri)
+	{
+		return SwitchResult { stackPointer, basepri };
+	}
+
+	/**
+	 * @brief Gets the current executing Cortex-M type
+	 * @return Always @c Type::M4
+	 */
+	static Type getType()
+	{
+		return Type::M4;
+	}
+
+	/**
+	 * @brief Gets the current number of preemption bits
+	 * @return The current number of preemption bits
+	 */
+	static uint8_t preemptBits()
+	{
+		return s_preemptBits;
+	}
+
+	/**
+	 * @brief Sets the number of preemption bits
+	 * @param value The required number of preemption bits
+	 * @warning The @p value should be between @c 0 and the number of priority bits actually implemented in the Cortex
+	 */
+	static void preemptBits(uint8_t value)
+	{
+		assert(value <= kPrigroupMax + 1);
+		s_preemptBits = value;
+	}
+
+	/**
+	 * @brief Enables the System Tick (Systick) counter with the specified reload counter
+	 * @param reload The reload counter, counter is decremented each clock cycle and a Systick interrupt is generated when it reaches @c 0, then reloaded with this value
+	 */
+	static void enableSystick(uint32_t reload);
+
+	/**
+	 * @brief Gets the current Systick counter value
+	 * @return The current Systick value
+	 * @remark This value is actually going up, and is the difference between the reload value and the current value of the timer (which decrements)
+	 */
+	static uint32_t systickCount();
+
+	/**
+	 * @brief Gets the raw Systick counter value
+	 * @return The current Systick value, which decrements down to @c 0 before being reloaded
+	 */
+	static uint32_t systickValue();
+
+	/**
+	 * @brief Gets the maximum number of cycles a single Systick period can last
+	 * @return The maximum number of cycles a single Systick period can last
+	 */
+	static constexpr uint32_t systickMaxReload()
+	{
+		return SystickReloadMask + 1;
+	}
+
+	/**
+	 * @brief Stops the Systick counter, keeping its current value
+	 */
+	static void stopSystick();
+
+	/**
+	 * @brief Resumes the Systick counter from its current value
+	 */
+	static void resumeSystick();
+
+	/**
+	 * @brief Restarts the Systick counter for a single period of @p first cycles, followed by periods of @p reload cycles
+	 * @param first The length of the first period, in cycles
+	 * @param reload The length of the following periods, in cycles
+	 */
+	static void restartSystick(uint32_t first, uint32_t reload);
+
+	/**
+	 * @brief Checks if the Systick interrupt is pending
+	 * @return @c true if the Systick interrupt is pending, @c false otherwise
+	 */
+	static bool isSystickPending();
+
+	/**
+	 * @brief Enables a peripheral interrupt
+	 * @param irq The interrupt request to enable
+	 * @warning Make sure the handler and priority are set before you enable an interrupt
+	 */
+	static void enableInterrupt(uint32_t irq);
+
+	/**
+	 * @brief Disables a peripheral interrupt
+	 * @param irq The interrupt request to disable
+	 */
+	static void disableInterrupt(uint32_t irq);
+
+	/**
+	 * @brief Checks if a peripheral interrupt is pending
+	 * @param irq The interrupt request to check
+	 * @return @c true if the interrupt is pending, @c false otherwise
+	 */
+	static bool isPending(uint32_t irq)
+	{
+		assert(irq <= MaxIrq);
+		return s_pending[irq + kSystemIrqs];
+	}
+
+	/**
+	 * @brief Sets the pending status for a peripheral interrupt
+	 * @param irq The interrupt request to set pending flag for
+	 * @remark This is how simulated peripherals raise their interrupt
+	 */
+	static void setPending(uint32_t irq);
+
+	/**
+	 * @brief Clears the pending flag for a peripheral interrupt
+	 * @param irq The interrupt request to clear pending flag for
+	 */
+	static void clearPending(uint32_t irq);
+
+	/**
+	 * @brief Triggers an instruction synchronization barrier
+	 */
+	static inline void instructionBarrier()
+	{
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+	}
+
+	/**
+	 * @brief  Triggers a data synchronization barrier
+	 */
+	static inline void dataBarrier()
+	{
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+	}
+
+	/**
+	 * @brief Checks if a peripheral interrupt is active
+	 * @param irq The interrupt request to check
+	 * @return @c true if the interrupt is active, @c false otherwise
+	 */
+	static bool isActive(uint32_t irq);
+
+	/**
+	 * @brief Sets the priority for a peripheral interrupt
+	 * @param irq The interrupt request to set priority for
+	 * @param priority The priority
+	 */
+	static void setPriority(uint32_t irq, IsrPriority priority)
+	{
+		assert(irq <= MaxIrq);
+		s_priorities[irq + kSystemIrqs] = priority.maskedValue<kPriorityBits>();
+	}
+
+	/**
+	 * @brief Gets the current priority for a peripheral interrupt
+	 * @param irq The interrupt request to get priority for
+	 * @return The interrupt priority
+	 */
+	static IsrPriority getPriority(uint32_t irq)
+	{
+		assert(irq <= MaxIrq);
+		return IsrPriority(s_priorities[irq + kSystemIrqs]);
+	}
+
+	/**
+	 * @brief Sets the priority for a system interrupt
+	 * @param irq The interrupt request to set priority for
+	 * @param priority The priority
+	 * @warning Only @c SystemIrq::ServiceCall, @c SystemIrq::PendSV and @c SystemIrq::Systick are configurable
+	 */
+	static void setPriority(SystemIrq irq, IsrPriority priority)
+	{
+		assert(irq == SystemIrq::ServiceCall || irq == SystemIrq::PendSV || irq == SystemIrq::Systick);
+		s_priorities[static_cast<std::size_t>(irq)] = priority.maskedValue<kPriorityBits>();
+	}
+
+	/**
+	 * @brief Gets the current priority for a system interrupt
+	 * @param irq The interrupt request to get priority for
+	 * @return The current priority
+	 * @warning Only @c SystemIrq::ServiceCall, @c SystemIrq::PendSV and @c SystemIrq::Systick are configurable
+	 */
+	static IsrPriority getPriority(SystemIrq irq)
+	{
+		assert(irq == SystemIrq::ServiceCall || irq == SystemIrq::PendSV || irq == SystemIrq::Systick);
+		return IsrPriority(s_priorities[static_cast<std::size_t>(irq)]);
+	}
+
+	/**
+	 * @brief Minimum (lowest) preemption priority available
+	 * @tparam PreemptBits Number of preemption bits
+	 * @return The minimum (lowest) preemption priority available
+	 */
+	template<std::size_t PreemptBits = kPreemptionBits>
+	static constexpr uint8_t minSub()
+	{
+		return (1 << (kPrigroupMax + 1 - PreemptBits)) - 1;
+	}
+
+	/**
+	 * @brief Minimum (lowest) sub-priority available
+	 * @tparam PreemptBits Number of preemption bits
+	 * @return The minimum (lowest) sub-priority available
+	 */
+	template<std::size_t PreemptBits = kPreemptionBits>
+	static constexpr uint8_t minPreempt()
+	{
+		return (1 << PreemptBits) - 1;
+	}
+
+	/**
+	 * @brief Generates a system reset
+	 * @remark On the host, this exits the process
+	 */
+	static void __attribute__((noreturn)) reset();
+
+	/**
+	 * @brief Gets the current interrupt handler vector
+	 * @return The current interrupt handler vector
+	 */
+	static IsrHandler* getVtor()
+	{
+		return s_vtor;
+	}
+
+	/**
+	 * @brief Moves the interrupt handler vector to a new location
+	 * @param vtor The new interrupt handler vector
+	 * @param copySize Number of handlers to copy from the previous to the new one
+	 */
+	static void moveVtor(IsrHandler* vtor, std::size_t copySize = 0)
+	{
+		assert(vtor != nullptr);
+		assert(copySize <= MaxIrq + kSystemIrqs);
+
+		for (auto i = 0u; i < copySize; ++i)
+			vtor[i] = getVtor()[i];
+
+		s_vtor = vtor;
+	}
+
+	/**
+	 * @brief Gets the current interrupt handler for a system interrupt
+	 * @param irq The interrupt request to get the handler for
+	 * @return The current handler of the specified system interrupt
+	 */
+	static IsrHandler getIsrHandler(SystemIrq irq)
+	{
+		assert(irq != SystemIrq::InitialSp);
+		return getVtor()[static_cast<std::size_t>(irq)];
+	}
+
+	/**
+	 * @brief Gets the current interrupt handler for a peripheral interrupt
+	 * @param irq The interrupt request to get the handler for
+	 * @return The current handler of the specified peripheral interrupt
+	 */
+	static IsrHandler getIsrHandler(uint32_t irq)
+	{
+		assert(irq <= MaxIrq);
+		return getVtor()[irq + kSystemIrqs];
+	}
+
+	/**
+	 * @brief Gets the value set to main stack pointer (MSP) at system reset (or startup)
+	 * @return Always @c nullptr, the host has no main stack to switch to
+	 */
+	static uint32_t* mspAtReset()
+	{
+		return nullptr;
+	}
+
+	/**
+	 * Sets the interrupt service routine for the specified system interrupt
+	 * @param irq The interrupt request to set the handler for
+	 * @param handler The interrupt service routine handler
+	 */
+	static void setIsrHandler(SystemIrq irq, IsrHandler handler)
+	{
+		assert(irq != SystemIrq::InitialSp);
+		getVtor()[static_cast<std::size_t>(irq)] = handler;
+	}
+
+	/**
+	 * @brief Sets the interrupt service routine for the specified peripheral interrupt
+	 * @param irq The interrupt request to set the handler for
+	 * @param handler The interrupt service routine handler
+	 */
+	static void setIsrHandler(uint32_t irq, IsrHandler handler)
+	{
+		assert(irq <= MaxIrq);
+		getVtor()[irq + kSystemIrqs] = handler;
+	}
+
+	/**
+	 * @brief Tries to get the priority of the currently executing interrupt service routine
+	 * @return @c nullopt if no ISR currently executing, the @c IsrPriority of the current ISR otherwise
+	 */
+	static std::optional<IsrPriority> currentPriority()
+	{
+		auto ipsrValue = ipsr();
+
+		if (ipsrValue == 0)
+			return std::nullopt;
+
+		return IsrPriority(s_priorities[ipsrValue]);
+	}
+
+	/**
+	 * @brief Gets the value of IPSR register
+	 * @return The number of the exception being handled, @c 0 in thread mode
+	 */
+	static uint32_t ipsr()
+	{
+		return s_depth == 0 ? 0 : s_active[s_depth - 1];
+	}
+
+	/**
+	 * @brief Waits for an interrupt
+	 * @remark The process sleeps until the next signal (Systick or peripheral)
+	 */
+	static void wfi();
+
+	/**
+	 * @brief Waits for an event
+	 * @remark There is no event on the host, this is the same as @c wfi
+	 */
+	static void wfe()
+	{
+		wfi();
+	}
+
+	/**
+	 * @brief Outputs a @c NOP instruction, which does nothing
+	 */
+	static void nop() __attribute__((always_inline))
+	{
+		asm volatile("nop");
+	}
+
+	/**
+	 * @brief Gets the current @c MSP (Main Stack Pointer) value
+	 * @return The last value set, the host has no such register
+	 */
+	static uint32_t* getMsp()
+	{
+		return s_msp;
+	}
+
+	/**
+	 * @brief Sets the @c MSP (Main Stack Pointer) value
+	 * @param msp The value to set @c MSP to
+	 */
+	static void setMsp(uint32_t* msp)
+	{
+		s_msp = msp;
+	}
+
+	/**
+	 * @brief Gets the current @c PSP (Process Stack Pointer) value
+	 * @return The last value set, the host has no such register
+	 */
+	static uint32_t* getPsp()
+	{
+		return s_psp;
+	}
+
+	/**
+	 * @brief Sets the @c PSP (Process Stack Pointer) value
+	 * @param psp The value to set @c PSP to
+	 */
+	static void setPsp(uint32_t* psp)
+	{
+		s_psp = psp;
+	}
+
+	/**
+	 * @brief Sets the @c CONTROL register value
+	 * @param control The value to set @c CONTROL register to
+	 */
+	static void setControl(uint32_t control)
+	{
+		s_control = control;
+	}
+
+	/**
+	 * @brief Gets the current @c CONTROL register value
+	 * @return The current @c CONTROL register value
+	 */
+	static uint32_t getControl()
+	{
+		return s_control;
+	}
+
+	/**
+	 * @brief Triggers the pending state for system interrupt @c PendSV
+	 */
+	static void triggerPendSv()
+	{
+		setPendingException(static_cast<std::size_t>(SystemIrq::PendSV));
+	}
+
+	/**
+	 * @brief Clears the pending state for system interrupt @c PendSV
+	 */
+	static void clearPendSv()
+	{
+		clearPendingException(static_cast<std::size_t>(SystemIrq::PendSV));
+	}
+
+	/**
+	 * @brief Sets the @c BASEPRI register value, and gets back its previous value
+	 * @param priority The new @c IsrPriority to set @c BASEPRI register to
+	 * @return The previous value of @c BASEPRI register
+	 */
+	static inline IsrPriority setBasepri(IsrPriority priority = IsrPriority(0))
+	{
+		const auto previous = s_basepri;
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+		s_basepri = priority.maskedValue<kPriorityBits>();
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+
+		if (s_pendingCount != 0) // unmasking may let a pending exception run
+			dispatch();
+
+		return IsrPriority(previous);
+	}
+
+	/**
+	 * @brief Disables all interrupts by setting @c PRIMASK register to 1
+	 */
+	static inline void disableInterrupts()
+	{
+		s_primask = true;
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+	}
+
+	/**
+	 * @brief Enables all interrupts by setting @c PRIMASK to 0
+	 * @warning This does not mean all peripheral interrupts are enabled, it means they are not masked by @c PRIMASK anymore
+	 */
+	static inline void enableInterrupts()
+	{
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+		s_primask = false;
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+
+		if (s_pendingCount != 0)
+			dispatch();
+	}
+
+	/**
+	 * @brief Checks if PRIMASK register is set to @c 1
+	 * @return @c true if @c PRIMASK is set to @c 1 (all interrupts disabled), @c false otherwise
+	 */
+	static inline bool isPrimask()
+	{
+		return s_primask;
+	}
+
+	/**
+	 * @brief Enabled the Floating Point Unit (FPU), nothing to do on the host
+	 */
+	static inline void enableFpu()
+	{
+	}
+
+	/**
+	 * @brief Loads a specific address and set the exclusive monitor
+	 * @param ptr The address to load from
+	 * @return The loaded address
+	 * @remark The simulated monitor is cleared by any exception entry or return, like on the target
+	 */
+	template<typename T>
+	static inline T loadExclusive(T* ptr)
+	{
+		static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4, "Wrong template parameter size for loadExclusive");
+		s_exclusive = ptr;
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+		return *const_cast<volatile T*>(ptr);
+	}
+
+	/**
+	 * @brief Tries to store the value to a specific address with excluve monitor check
+	 * @param ptr The pointer to store to
+	 * @param value The value to store
+	 * @return @c 0 if the store is effective, @c 1 otherwise
+	 */
+	template<typename T>
+	static inline uint32_t storeExclusive(T* ptr, T value)
+	{
+		static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4, "Wrong template parameter size for storeExclusive");
+		uint32_t result = 1;
+
+		enterPort(); // an exception cannot be taken between the check and the store
+		if (s_exclusive == ptr)
+		{
+			*const_cast<volatile T*>(ptr) = value;
+			result = 0;
+		}
+		s_exclusive = nullptr;
+		exitPort();
+
+		return result;
+	}
+
+	/**
+	 * @brief Triggers a service call
+	 * @tparam Number The service call number
+	 * @param r0 The first argument
+	 * @param r1 The second argument
+	 * @param r2 The third argument
+	 * @return The value of R0 when the service call returns
+	 */
+	template<uint8_t Number>
+	static inline uintptr_t serviceCall(uintptr_t r0 = 0, uintptr_t r1 = 0, uintptr_t r2 = 0)
+	{
+		StackFrame frame { r0, r1, r2, 0 };
+		serviceCall(Number, frame);
+		return frame.r0;
+	}
+
+	/**
+	 * @brief Gets the arguments of the service call being handled
+	 * @return The arguments of the service call being handled
+	 */
+	static StackFrame* serviceCallFrame()
+	{
+		return s_serviceFrame;
+	}
+
+	/**
+	 * @brief Gets the number of the service call being handled
+	 * @return The number of the service call being handled
+	 */
+	static uint8_t serviceCallNumber()
+	{
+		return s_serviceNumber;
+	}
+
+	/**
+	 * @brief Checks if the service call being handled was triggered from thread mode
+	 * @return @c true if the service call was triggered from thread mode, @c false otherwise
+	 */
+	static bool serviceCallFromThread()
+	{
+		return s_serviceFromThread;
+	}
+
+	/**
+	 * @brief Prepares a host stack to run @p entry
+	 * @param stackBase The base of the target stack, it identifies the host stack (which is reused at each call)
+	 * @param entry The function to run
+	 * @param argument The argument to give to @p entry
+	 * @return The "stack pointer" to give to the @c PendSV handler to start @p entry
+	 * @remark The target stack is not used, code runs on a host stack allocated the first time a @p stackBase is seen
+	 */
+	static uint32_t* prepareStack(uint32_t* stackBase, void (*entry)(void*), void* argument);
+
+	/**
+	 * @brief Does the @c PendSV part of the context switch: saves the current context, calls @p handler and switches to the context it returns
+	 * @param handler The kernel handler, it gets the current "stack pointer" and returns the one to switch to
+	 */
+	static void switchContext(SwitchResult (*handler)(uint32_t*));
+
+	/**
+	 * @brief Counts the leading zero bits of a value
+	 * @param value The value to count leading zeros of
+	 * @return The number of leading zero bits, from @c 0 (most significant bit set) to @c 32 (@p value is @c 0)
+	 */
+	static constexpr inline uint8_t countLeadingZeros(uint32_t value)
+	{
+		return value == 0 ? 32 : static_cast<uint8_t>(__builtin_clz(value));
+	}
+
+	/**
+	 * @brief Counts the trailing zero bits of a value
+	 * @param value The value to count trailing zeros of
+	 * @return The number of trailing zero bits, from @c 0 (least significant bit set) to @c 32 (@p value is @c 0)
+	 */
+	static constexpr inline uint8_t countTrailingZeros(uint32_t value)
+	{
+		return value == 0 ? 32 : static_cast<uint8_t>(__builtin_ctz(value));
+	}
+
+	/**
+	 * @brief Simulates the execution of code lasting @p cycles core cycles
+	 * @param cycles The number of core cycles the simulated code lasts
+	 * @remark In virtual time, the clock advances and interrupts that occur in the meantime preempt the caller, otherwise this is a busy wait on the host clock
+	 */
+	static void elapse(uint64_t cycles);
+
+	/**
+	 * @brief Seeds the simulation pseudo random generator
+	 * @param value The seed
+	 * @remark The generator is seeded from the @c OPSY_SEED environment variable when the Systick is enabled, if it is defined
+	 */
+	static void seed(uint64_t value);
+
+	/**
+	 * @brief Gets a pseudo random number, to model workloads and simulated peripherals
+	 * @return The next pseudo random number
+	 * @remark Using it (instead of host sources) keeps a virtual time run reproducible from its seed
+	 */
+	static uint32_t random();
+
+	/**
+	 * @brief Enables the cycle counter, the simulated one always runs
+	 */
+	static void enableCycleCount()
+	{
+	}
+
+	/**
+	 * @brief Gets the simulated cycle counter
+	 * @return The number of core cycles elapsed, based on the host monotonic clock and @c SystemCoreClock, or the virtual clock
+	 */
+	static uint32_t cycleCount();
+
+	/**
+	 * @brief Sets the simulated cycle counter
+	 * @param value The new value of the cycle counter
+	 */
+	static void cycleCount(uint32_t value);
+
+private:
+
+	static constexpr std::size_t SystickReloadBits = 24;
+	static constexpr uint32_t SystickReloadMask = (1 << SystickReloadBits) - 1;
+
+	static constexpr uint32_t MaxIrq = 239; // Cortex-M can handle up to 240 external IRQs
+	static constexpr std::size_t MaxDepth = 32; // deepest exception nesting
+
+	static IsrHandler s_vector[MaxIrq + 1 + kSystemIrqs];
+	static IsrHandler* s_vtor;
+	static uint8_t s_priorities[MaxIrq + 1 + kSystemIrqs];
+	static volatile bool s_pending[MaxIrq + 1 + kSystemIrqs];
+	static bool s_enabled[MaxIrq + 1];
+	static volatile uint32_t s_pendingCount;
+	static uint16_t s_active[MaxDepth];
+	static volatile std::size_t s_depth;
+	static volatile uint8_t s_basepri;
+	static volatile bool s_primask;
+	static uint8_t s_preemptBits;
+	static const volatile void* s_exclusive;
+	static volatile uint32_t s_portLock;
+	static volatile bool s_deferred;
+
+	static StackFrame* s_serviceFrame;
+	static uint8_t s_serviceNumber;
+	static bool s_serviceFromThread;
+
+	static uint32_t* s_msp;
+	static uint32_t* s_psp;
+	static uint32_t s_control;
+
+	static void enterPort()
+	{
+		s_portLock = s_portLock + 1;
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+	}
+
+	static void exitPort();
+	static void markPending(std::size_t exception);
+	static int selectPending();
+	static void take(std::size_t exception);
+	static void dispatch();
+	static void setPendingException(std::size_t exception);
+	static void clearPendingException(std::size_t exception);
+	static void serviceCall(uint8_t number, StackFrame& frame);
+	static uint64_t updateSystick();
+	static void armSystick();
+	static void tick();
+	static void onAlarm(int);
+	static void trampoline(unsigned int high, unsigned int low);
+};
+}
@@ -0,0 +1,87 @@
+#include <opsy.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+using namespace opsy;
+using namespace std::chrono_literals;
+
+static_assert(kVirtualTime, "build with -DOPSY_VIRTUAL_TIME=true");
+
+namespace
+{
+
+constexpr auto kOwnerPriority = static_cast<Priority>(0x80);
+constexpr auto kWaiterPriority = static_cast<Priority>(0x10);
+constexpr auto kMonitorPriority = static_cast<Priority>(0x08);
+constexpr uint32_t kRounds = 10;
+constexpr auto kTimeout = 5ms;
+constexpr auto kHold = 20ms; // the owner holds the mutex well past the timeout of the waiter
+
+Task<4096> s_owner;
+Task<4096> s_waiter;
+Task<4096> s_monitor;
+InheritanceMutex s_mutex;
+
+time_point s_deadline;
+volatile uint32_t s_rounds = 0;
+volatile uint32_t s_failures = 0; // times the owner still had the priority of the waiter after its timeout
+
+}
+
+/**
+ * The waiter gives up an InheritanceMutex on timeout while the owner holds it: the owner must lose the inherited
+ * Priority in the tick of the timeout, before the waiter runs again. The monitor, more important, wakes up in
+ * the same tick and checks it
+ */
+int main()
+{
+	s_monitor.priority(kMonitorPriority);
+	s_monitor.start([]()
+		{
+			while (true)
+			{
+				Scheduler::waitNotification();
+				const auto deadline = s_deadline;
+				sleep_until(deadline); // the waiter times out in the same tick, but runs after
+				if (s_deadline != deadline) // the waiter got the mutex and already waits again, its owner rightly inherits
+					continue;
+				if (s_owner.priority() != kOwnerPriority)
+					s_failures = s_failures + 1;
+				s_rounds = s_rounds + 1;
+			}
+		}, "monitor");
+
+	s_waiter.priority(kWaiterPriority);
+	s_waiter.start([]()
+		{
+			while (true)
+			{
+				sleep_for(1ms); // the owner takes the mutex in between
+				s_deadline = Scheduler::now() + kTimeout;
+				s_monitor.notify(NotifyAction::Increment);
+				if (s_mutex.try_lock_until(s_deadline))
+					s_mutex.unlock();
+			}
+		}, "waiter");
+
+	s_owner.priority(kOwnerPriority);
+	s_owner.start([]()
+		{
+			while (s_rounds < kRounds)
+			{
+				{
+					std::lock_guard<InheritanceMutex> lock(s_mutex);
+					CortexM::elapse(static_cast<uint64_t>(getCoreClock()) * kHold.count() / 1000);
+				}
+				sleep_for(1ms);
+			}
+
+			std::printf("rounds %lu, failures %lu\n", static_cast<unsigned long>(s_rounds), static_cast<unsigned long>(s_failures));
+			std::exit(s_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+		}, "owner");
+
+	Scheduler::start();
+	return EXIT_FAILURE;
+}
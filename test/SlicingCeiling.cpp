@@ -0,0 +1,68 @@
+#include <opsy.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+using namespace opsy;
+using namespace std::chrono_literals;
+
+static_assert(kTimeSlicing && kVirtualTime, "build with -DOPSY_TIME_SLICING=true -DOPSY_VIRTUAL_TIME=true");
+
+namespace
+{
+
+constexpr auto kOwnerPriority = static_cast<Priority>(0x80);
+constexpr auto kCeiling = static_cast<Priority>(0x10);
+constexpr auto kPeerPriority = kCeiling; // a peer of the raised owner, time slicing applies between them
+constexpr uint32_t kRounds = 20;
+constexpr auto kHold = 4 * timeSlice(static_cast<uint8_t>(kCeiling)); // the owner holds the mutex for several time slices
+
+Task<4096> s_owner;
+Task<4096> s_peer;
+CeilingMutex s_mutex(kCeiling);
+
+volatile uint32_t s_rounds = 0;
+volatile uint32_t s_failures = 0; // times the peer found the mutex taken, it ran in the critical section of the owner
+
+}
+
+/**
+ * The owner holds a CeilingMutex for several time slices while a task of the ceiling Priority is ready:
+ * slicing must not rotate the owner behind it, the peer would run while the mutex is taken
+ */
+int main()
+{
+	s_peer.priority(kPeerPriority);
+	s_peer.start([]()
+		{
+			while (true)
+			{
+				sleep_for(5ms); // wakes up in the middle of the critical section
+				if (s_mutex.try_lock())
+					s_mutex.unlock();
+				else
+					s_failures = s_failures + 1;
+				s_rounds = s_rounds + 1;
+			}
+		}, "peer");
+
+	s_owner.priority(kOwnerPriority);
+	s_owner.start([]()
+		{
+			while (s_rounds < kRounds)
+			{
+				{
+					std::lock_guard<CeilingMutex> lock(s_mutex);
+					CortexM::elapse(static_cast<uint64_t>(getCoreClock()) * kHold.count() / 1000);
+				}
+				sleep_for(1ms);
+			}
+
+			std::printf("rounds %lu, failures %lu\n", static_cast<unsigned long>(s_rounds), static_cast<unsigned long>(s_failures));
+			std::exit(s_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+		}, "owner");
+
+	Scheduler::start();
+	return EXIT_FAILURE;
+}
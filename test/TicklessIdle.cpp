@@ -0,0 +1,76 @@
+#include <opsy.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace opsy;
+using namespace std::chrono_literals;
+
+static_assert(kTicklessIdle && kVirtualTime, "build with -DOPSY_TICKLESS_IDLE=true -DOPSY_VIRTUAL_TIME=true");
+
+namespace
+{
+
+constexpr auto kIdle = 1000ms; // idle stretch measured
+constexpr auto kPeriod = 100ms; // of the periodic wake ups
+
+Task<4096> s_task;
+volatile uint32_t s_systicks = 0;
+
+void countingSystick()
+{
+	s_systicks = s_systicks + 1;
+	SysTick_Handler();
+}
+
+/**
+ * @brief Counts the Systick interrupts while @p idle runs
+ * @return The number of Systick interrupts
+ */
+template<typename Idle>
+uint32_t count(Idle&& idle)
+{
+	const auto before = s_systicks;
+	idle();
+	return s_systicks - before;
+}
+
+}
+
+/**
+ * With tickless idle, the Systick is stretched up to the next timeout when nothing runs:
+ * a long sleep takes one interrupt per longest Systick period instead of one per tick
+ */
+int main()
+{
+	s_task.start([]()
+		{
+			CortexM::setIsrHandler(CortexM::SystemIrq::Systick, countingSystick);
+
+			const auto tickCycles = static_cast<uint64_t>(getCoreClock()) * duration::period::num / duration::period::den;
+			const auto longestStretch = static_cast<uint32_t>((CortexM::systickMaxReload() + 1) / tickCycles); // in ticks
+			const auto ticks = static_cast<uint32_t>(duration(kIdle).count());
+
+			auto start = Scheduler::now();
+			const auto sleeping = count([]() { sleep_for(kIdle); });
+			const bool sleptEnough = Scheduler::now() - start >= kIdle;
+			const auto sleepingBound = ticks / longestStretch + 3; // plus the ticks around the start and the end of the stretch
+
+			start = Scheduler::now();
+			const auto periodic = count([start]()
+				{
+					for (auto next = start + kPeriod; next <= start + kIdle; next += kPeriod)
+						sleep_until(next);
+				});
+			const auto periodicBound = 3 * static_cast<uint32_t>(kIdle / kPeriod); // a few per wake up, whatever the period
+
+			std::printf("ticks %lu, systicks while sleeping %lu (bound %lu), while waking up every %ldms %lu (bound %lu)\n", static_cast<unsigned long>(ticks),
+					static_cast<unsigned long>(sleeping), static_cast<unsigned long>(sleepingBound), static_cast<long>(duration(kPeriod).count()),
+					static_cast<unsigned long>(periodic), static_cast<unsigned long>(periodicBound));
+
+			std::exit(sleptEnough && sleeping <= sleepingBound && periodic <= periodicBound ? EXIT_SUCCESS : EXIT_FAILURE);
+		}, "idle");
+
+	Scheduler::start();
+	return EXIT_FAILURE;
+}